@@ -0,0 +1,162 @@
+/*
+ * Série temporal da bateria por dispositivo, em buffer
+ *
+ * Cada amostra é uma linha (instante, energia restante de cada dispositivo)
+ * gravada num buffer colunar pré-alocado; nada vai para o disco até o buffer
+ * encher ou o arquivo ser fechado, e então o bloco inteiro sai em duas
+ * chamadas fwrite. Com N dispositivos e buffer de B bytes, uma execução de
+ * anos com amostras a cada minuto faz poucas escritas grandes em vez de uma
+ * abertura/escrita/fechamento por amostra.
+ *
+ * Formato (.lpwb, binário, ordem de bytes da máquina):
+ *   cabeçalho: "LPWB", uint32 versão (1), uint32 dispositivos, uint32 0,
+ *              double intervalo de amostragem (s)
+ *   blocos:    uint32 linhas, uint32 0, double tempo[linhas],
+ *              float energia[linhas][dispositivos] (J)
+ * Um arquivo por execução, escrito em <caminho>.tmp.<pid> e renomeado em
+ * Close(), como os shards de lpwan-result-sink.h. ReadBatteryFile() lê de
+ * volta; em Python: numpy.fromfile bloco a bloco com os mesmos tamanhos.
+ */
+
+#ifndef LPWAN_BATTERY_RECORDER_H
+#define LPWAN_BATTERY_RECORDER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace lpwan {
+
+static const uint32_t BATTERY_FILE_VERSION = 1;
+
+class BatteryRecorder {
+public:
+    BatteryRecorder() = default;
+    BatteryRecorder(const BatteryRecorder&) = delete;
+    BatteryRecorder& operator=(const BatteryRecorder&) = delete;
+
+    ~BatteryRecorder() {
+        if (m_file) {
+            try {
+                Close();
+            } catch (const std::exception&) {
+                // destrutor não propaga; chame Close() para ver o erro
+            }
+        }
+    }
+
+    // bufferBytes: tamanho aproximado do buffer (pelo menos uma linha)
+    void Open(const std::string& path, uint32_t devices, double interval, size_t bufferBytes = 4 << 20) {
+        m_path = path;
+        m_tmpPath = path + ".tmp." + std::to_string(::getpid());
+        m_file = std::fopen(m_tmpPath.c_str(), "wb");
+        if (!m_file) {
+            throw std::runtime_error("não foi possível criar " + m_tmpPath);
+        }
+        m_devices = devices;
+        m_capacity = std::max<size_t>(bufferBytes / (sizeof(double) + sizeof(float) * std::max(devices, 1u)), 1);
+        m_times.assign(m_capacity, 0.0);
+        m_values.assign(m_capacity * devices, 0.0f);
+        m_rows = 0;
+
+        uint32_t header[4] = {0, BATTERY_FILE_VERSION, devices, 0};
+        std::memcpy(header, "LPWB", 4);
+        Write(header, sizeof(header));
+        Write(&interval, sizeof(interval));
+    }
+
+    bool IsOpen() const { return m_file != nullptr; }
+
+    // Reserva a próxima linha e devolve onde escrever os `devices` valores
+    float* NextRow(double time) {
+        if (m_rows == m_capacity) {
+            Flush();
+        }
+        m_times[m_rows] = time;
+        return &m_values[m_rows++ * m_devices];
+    }
+
+    // Grava o bloco pendente
+    void Flush() {
+        if (m_rows == 0) {
+            return;
+        }
+        uint32_t block[2] = {static_cast<uint32_t>(m_rows), 0};
+        Write(block, sizeof(block));
+        Write(m_times.data(), m_rows * sizeof(double));
+        Write(m_values.data(), m_rows * m_devices * sizeof(float));
+        m_rows = 0;
+    }
+
+    void Close() {
+        Flush();
+        bool ok = std::fclose(m_file) == 0;
+        m_file = nullptr;
+        if (!ok || std::rename(m_tmpPath.c_str(), m_path.c_str()) != 0) {
+            std::remove(m_tmpPath.c_str());
+            throw std::runtime_error("falha ao gravar " + m_path);
+        }
+    }
+
+private:
+    void Write(const void* data, size_t bytes) {
+        if (bytes > 0 && std::fwrite(data, 1, bytes, m_file) != bytes) {
+            throw std::runtime_error("falha ao gravar " + m_tmpPath);
+        }
+    }
+
+    std::string m_path;
+    std::string m_tmpPath;
+    FILE* m_file = nullptr;
+    uint32_t m_devices = 0;
+    size_t m_capacity = 0;
+    size_t m_rows = 0;
+    std::vector<double> m_times;
+    std::vector<float> m_values; // linha-major: [linha][dispositivo]
+};
+
+// Conteúdo de um .lpwb
+struct BatterySeries {
+    uint32_t devices = 0;
+    double interval = 0.0;
+    std::vector<double> times;
+    std::vector<float> values; // [amostra][dispositivo]
+};
+
+inline BatterySeries ReadBatteryFile(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        throw std::runtime_error("não foi possível abrir " + path);
+    }
+    BatterySeries s;
+    uint32_t header[4];
+    if (std::fread(header, sizeof(header), 1, f) != 1 || std::memcmp(header, "LPWB", 4) != 0 ||
+        header[1] != BATTERY_FILE_VERSION || std::fread(&s.interval, sizeof(double), 1, f) != 1) {
+        std::fclose(f);
+        throw std::runtime_error(path + ": não é um arquivo de bateria");
+    }
+    s.devices = header[2];
+    uint32_t block[2];
+    while (std::fread(block, sizeof(block), 1, f) == 1) {
+        size_t t0 = s.times.size();
+        s.times.resize(t0 + block[0]);
+        s.values.resize(s.times.size() * s.devices);
+        if (std::fread(&s.times[t0], sizeof(double), block[0], f) != block[0] ||
+            std::fread(&s.values[t0 * s.devices], sizeof(float), size_t(block[0]) * s.devices, f) !=
+                size_t(block[0]) * s.devices) {
+            std::fclose(f);
+            throw std::runtime_error(path + ": bloco truncado");
+        }
+    }
+    std::fclose(f);
+    return s;
+}
+
+} // namespace lpwan
+
+#endif // LPWAN_BATTERY_RECORDER_H
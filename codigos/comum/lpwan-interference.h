@@ -0,0 +1,176 @@
+/*
+ * Rastreador de interferência entre transmissões simultâneas
+ *
+ * Mantém, por chave (gateway, frequência, SF), as transmissões em curso e
+ * classifica cada uma quando termina: sem sobreposição, sobreposta mas
+ * capturada (potência >= interferente mais forte + captureDb) ou colidida.
+ * Não depende do NS-3; quem chama informa início, fim e potência recebida.
+ *
+ * Custo por transmissão O(log n), mesmo com milhares sobrepostas:
+ *   - as ativas ficam num heap por fim e num multiset de potências, que dá o
+ *     interferente mais forte já presente no início da transmissão;
+ *   - as que começam depois dela são um sufixo do vetor de inícios (ordem
+ *     cronológica); uma pilha monotônica de potências decrescentes responde
+ *     "máximo do sufixo" por busca binária.
+ * Uma transmissão é avaliada no primeiro Start() da mesma chave com instante
+ * >= seu fim (todos os inícios anteriores a esse instante a sobrepõem) ou
+ * em Finish(). Registros já avaliados saem da frente das filas.
+ */
+
+#ifndef LPWAN_INTERFERENCE_H
+#define LPWAN_INTERFERENCE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <queue>
+#include <set>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace lpwan {
+
+// Contadores por causa de perda (POD: volta pelo pipe das replicações)
+struct LossBreakdown {
+    uint64_t interference;     // PHY do gateway: perda por interferência
+    uint64_t underSensitivity; // PHY do gateway: abaixo da sensibilidade
+    uint64_t gatewayBusy;      // sem demodulador livre ou gateway transmitindo
+    uint64_t overlapped;       // rastreador: transmissões com sobreposição na mesma chave
+    uint64_t captured;         // rastreador: sobrepostas que sobrevivem por captura
+    uint64_t collided;         // rastreador: sobrepostas sem margem de captura
+};
+
+static_assert(std::is_trivially_copyable<LossBreakdown>::value, "LossBreakdown precisa ser POD");
+
+// Linhas extras do bloco "=== RESULTADOS ... ===" (ignoradas pelo conversor)
+inline void PrintLossBreakdown(std::ostream& os, const LossBreakdown& b) {
+    os << "Perdas por Interferência: " << b.interference << std::endl;
+    os << "Perdas por Sensibilidade: " << b.underSensitivity << std::endl;
+    os << "Perdas por Gateway Ocupado: " << b.gatewayBusy << std::endl;
+    os << "Transmissões Sobrepostas: " << b.overlapped << std::endl;
+    os << "Sobrepostas Capturadas: " << b.captured << std::endl;
+    os << "Sobrepostas Colididas: " << b.collided << std::endl;
+}
+
+class InterferenceTracker {
+public:
+    // captureDb: margem para o sinal sobreviver ao interferente mais forte
+    // do mesmo SF (6 dB na matriz de isolamento do módulo lorawan)
+    void Reset(double captureDb = 6.0) {
+        m_captureDb = captureDb;
+        m_keys.clear();
+        m_overlapped = 0;
+        m_captured = 0;
+        m_collided = 0;
+    }
+
+    static uint64_t MakeKey(uint32_t gateway, double frequencyMHz, uint32_t sf) {
+        uint64_t khz = static_cast<uint64_t>(frequencyMHz * 1000.0 + 0.5);
+        return (uint64_t(gateway) << 40) ^ (khz << 8) ^ sf;
+    }
+
+    void Start(uint64_t key, double start, double end, double rxPowerDbm) {
+        Key& k = m_keys[key];
+        Evaluate(k, start);
+
+        Tx tx;
+        tx.end = end;
+        tx.power = rxPowerDbm;
+        tx.preCount = k.activePowers.size();
+        tx.preMax = k.activePowers.empty() ? -std::numeric_limits<double>::infinity() : *k.activePowers.rbegin();
+        tx.done = false;
+
+        uint64_t idx = k.base + k.txs.size();
+        k.txs.push_back(tx);
+        k.activePowers.insert(rxPowerDbm);
+        k.byEnd.push(std::make_pair(end, idx));
+        while (!k.maxStack.empty() && k.maxStack.back().second <= rxPowerDbm) {
+            k.maxStack.pop_back();
+        }
+        k.maxStack.push_back(std::make_pair(idx, rxPowerDbm));
+    }
+
+    // Avalia todas as transmissões ainda pendentes (fim da simulação)
+    void Finish() {
+        for (auto& entry : m_keys) {
+            Evaluate(entry.second, std::numeric_limits<double>::infinity());
+        }
+    }
+
+    void AddTo(LossBreakdown& b) const {
+        b.overlapped += m_overlapped;
+        b.captured += m_captured;
+        b.collided += m_collided;
+    }
+
+private:
+    struct Tx {
+        double end;
+        double power;
+        uint64_t preCount; // ativas no início
+        double preMax;     // potência da mais forte entre elas
+        bool done;
+    };
+
+    using EndEntry = std::pair<double, uint64_t>;
+
+    struct Key {
+        uint64_t base = 0;             // índice global de txs.front()
+        std::deque<Tx> txs;            // em ordem de início
+        std::multiset<double> activePowers;
+        std::priority_queue<EndEntry, std::vector<EndEntry>, std::greater<EndEntry>> byEnd;
+        std::deque<std::pair<uint64_t, double>> maxStack; // (índice, potência), potências decrescentes
+    };
+
+    // Avalia as transmissões da chave que terminaram até `now`
+    void Evaluate(Key& k, double now) {
+        while (!k.byEnd.empty() && k.byEnd.top().first <= now) {
+            uint64_t idx = k.byEnd.top().second;
+            k.byEnd.pop();
+            Tx& tx = k.txs[idx - k.base];
+
+            uint64_t later = k.base + k.txs.size() - idx - 1;
+            double strongest = std::max(tx.preMax, SuffixMax(k, idx + 1));
+            if (tx.preCount + later > 0) {
+                m_overlapped++;
+                if (tx.power >= strongest + m_captureDb) {
+                    m_captured++;
+                } else {
+                    m_collided++;
+                }
+            }
+            tx.done = true;
+            k.activePowers.erase(k.activePowers.find(tx.power));
+        }
+        // Descarta os registros avaliados da frente (ninguém mais consulta
+        // índices anteriores à primeira transmissão ativa)
+        while (!k.txs.empty() && k.txs.front().done) {
+            k.txs.pop_front();
+            k.base++;
+        }
+        while (!k.maxStack.empty() && k.maxStack.front().first < k.base) {
+            k.maxStack.pop_front();
+        }
+    }
+
+    // Maior potência entre as transmissões com índice >= from
+    static double SuffixMax(const Key& k, uint64_t from) {
+        auto it = std::lower_bound(k.maxStack.begin(), k.maxStack.end(), from,
+                                   [](const std::pair<uint64_t, double>& e, uint64_t v) { return e.first < v; });
+        return it == k.maxStack.end() ? -std::numeric_limits<double>::infinity() : it->second;
+    }
+
+    double m_captureDb = 6.0;
+    std::unordered_map<uint64_t, Key> m_keys;
+    uint64_t m_overlapped = 0;
+    uint64_t m_captured = 0;
+    uint64_t m_collided = 0;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_INTERFERENCE_H
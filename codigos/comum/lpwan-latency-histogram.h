@@ -0,0 +1,177 @@
+/*
+ * Histograma de atraso com memória fixa (estilo HDR)
+ *
+ * Cada atraso (envio -> recepção, em microssegundos) cai num balde
+ * log-linear: valores abaixo de 128 µs têm balde próprio e, acima disso,
+ * cada oitava [2^k, 2^(k+1)) é dividida em 64 baldes iguais, então o erro
+ * relativo de qualquer percentil fica abaixo de 1/64 (~1,6%). A faixa vai
+ * até 2^37 µs (~38 h); valores maiores ficam no último balde. Inserção é
+ * O(1) (um clz), a memória é fixa (2048 contadores, 16 KB) e dois
+ * histogramas se somam balde a balde, então replicações paralelas se juntam
+ * sem perder a cauda. O máximo é guardado exato.
+ *
+ * LatencyReport junta o histograma geral com um por classe de dispositivo
+ * (SF no LoRaWAN, nível de CE no NB-IoT); tudo POD, volta dos workers de
+ * replicação pelo mesmo pipe do resultado.
+ */
+
+#ifndef LPWAN_LATENCY_HISTOGRAM_H
+#define LPWAN_LATENCY_HISTOGRAM_H
+
+#include "lpwan-run-result.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace lpwan {
+
+class LatencyHistogram {
+public:
+    static const uint32_t SUB_BITS = 7;
+    static const uint32_t HALF = 1u << (SUB_BITS - 1);
+    static const uint32_t MAX_BITS = 37;
+    static const uint32_t NUM_BUCKETS = (1u << SUB_BITS) + (MAX_BITS - SUB_BITS) * HALF;
+    static const uint64_t MAX_VALUE = (uint64_t(1) << MAX_BITS) - 1; // µs
+
+    void Reset() {
+        std::fill(m_counts, m_counts + NUM_BUCKETS, 0);
+        m_total = 0;
+        m_max = 0;
+    }
+
+    void Record(double seconds) {
+        uint64_t us = seconds > 0.0 ? std::min<uint64_t>(uint64_t(seconds * 1e6 + 0.5), MAX_VALUE) : 0;
+        m_counts[IndexOf(us)]++;
+        m_total++;
+        m_max = std::max(m_max, us);
+    }
+
+    void Merge(const LatencyHistogram& other) {
+        for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_total += other.m_total;
+        m_max = std::max(m_max, other.m_max);
+    }
+
+    uint64_t GetCount() const { return m_total; }
+    double GetMax() const { return m_max * 1e-6; }
+
+    // Menor valor (s) com pelo menos q × total amostras até ele; devolve o
+    // limite superior do balde, nunca acima do máximo exato
+    double Percentile(double q) const {
+        if (m_total == 0) {
+            return 0.0;
+        }
+        uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(q * m_total)));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+            seen += m_counts[i];
+            if (seen >= rank) {
+                return std::min(UpperOf(i), m_max) * 1e-6;
+            }
+        }
+        return GetMax();
+    }
+
+private:
+    static uint32_t IndexOf(uint64_t us) {
+        if (us < (1u << SUB_BITS)) {
+            return uint32_t(us);
+        }
+        uint32_t shift = (63 - __builtin_clzll(us)) - SUB_BITS + 1;
+        return (1u << SUB_BITS) + (shift - 1) * HALF + uint32_t(us >> shift) - HALF;
+    }
+
+    static uint64_t UpperOf(uint32_t index) {
+        if (index < (1u << SUB_BITS)) {
+            return index;
+        }
+        uint32_t k = index - (1u << SUB_BITS);
+        uint32_t shift = k / HALF + 1;
+        return ((uint64_t(HALF + k % HALF) + 1) << shift) - 1;
+    }
+
+    uint64_t m_counts[NUM_BUCKETS];
+    uint64_t m_total;
+    uint64_t m_max; // µs
+};
+
+static_assert(std::is_trivially_copyable<LatencyHistogram>::value, "LatencyHistogram precisa ser POD");
+
+static const uint32_t MAX_LATENCY_CLASSES = 8;
+
+// Histograma geral + um por classe de dispositivo
+struct LatencyReport {
+    LatencyHistogram all;
+    uint32_t numClasses;
+    char classNames[MAX_LATENCY_CLASSES][8];
+    LatencyHistogram byClass[MAX_LATENCY_CLASSES];
+
+    // Sem nomes (ou com um só) não há detalhe por classe
+    void Reset(const std::vector<std::string>& names = {}) {
+        all.Reset();
+        numClasses = std::min<uint32_t>(names.size(), MAX_LATENCY_CLASSES);
+        std::memset(classNames, 0, sizeof(classNames));
+        for (uint32_t c = 0; c < numClasses; ++c) {
+            std::strncpy(classNames[c], names[c].c_str(), sizeof(classNames[c]) - 1);
+            byClass[c].Reset();
+        }
+    }
+
+    void Record(uint32_t cls, double seconds) {
+        all.Record(seconds);
+        if (cls < numClasses) {
+            byClass[cls].Record(seconds);
+        }
+    }
+
+    // As duas partes precisam ter as mesmas classes
+    void Merge(const LatencyReport& other) {
+        all.Merge(other.all);
+        for (uint32_t c = 0; c < numClasses; ++c) {
+            byClass[c].Merge(other.byClass[c]);
+        }
+    }
+};
+
+static_assert(std::is_trivially_copyable<LatencyReport>::value, "LatencyReport precisa ser POD");
+
+// Percentis do histograma geral nas colunas do RunResult
+inline void FillDelayPercentiles(RunResult& r, const LatencyHistogram& h) {
+    r.delayP50 = h.Percentile(0.50);
+    r.delayP90 = h.Percentile(0.90);
+    r.delayP99 = h.Percentile(0.99);
+    r.delayMax = h.GetMax();
+}
+
+// "p50 / p90 / p99 / máx" em segundos
+inline std::string FormatPercentiles(const LatencyHistogram& h) {
+    std::ostringstream ss;
+    ss << h.Percentile(0.50) << " / " << h.Percentile(0.90) << " / " << h.Percentile(0.99) << " / " << h.GetMax();
+    return ss.str();
+}
+
+// Uma linha por classe com recepções (nada com uma classe só)
+inline void PrintLatencyReport(std::ostream& os, const LatencyReport& r) {
+    if (r.numClasses < 2) {
+        return;
+    }
+    for (uint32_t c = 0; c < r.numClasses; ++c) {
+        if (r.byClass[c].GetCount() > 0) {
+            os << "Atraso " << r.classNames[c] << " p50/p90/p99/máx (s): " << FormatPercentiles(r.byClass[c])
+               << " (" << r.byClass[c].GetCount() << " pacotes)" << std::endl;
+        }
+    }
+}
+
+} // namespace lpwan
+
+#endif // LPWAN_LATENCY_HISTOGRAM_H
@@ -0,0 +1,143 @@
+/*
+ * Tabela de orçamento de enlace para topologias estáticas
+ *
+ * Com nós fixos, a perda de percurso de cada par (dispositivo, gateway) não
+ * muda durante a simulação. A tabela calcula RSSI de todos os pares uma vez,
+ * antes de Simulator::Run(), com o mesmo modelo log-distância das
+ * simulações (LogDistancePropagationLossModel, inclusive o patamar abaixo da
+ * distância de referência). Os canais passam a ler a potência daqui, sem
+ * chamadas virtuais ao modelo de perda nem leitura de posições por evento.
+ *
+ * Layout: uma linha contígua de float por gateway (rssi[g * D + d]). O laço
+ * interno percorre as coordenadas dos dispositivos (vetores contíguos de
+ * Placement) sem dependências entre iterações e sem sqrt (usa
+ * 5·n·log10(d²)), então é auto-vetorizável; com -O3 -ffast-math o GCC troca
+ * log10 pela versão vetorial da libmvec.
+ *
+ * Também classifica cada dispositivo pelo melhor gateway: menor SF LoRa que
+ * fecha o enlace e classe de cobertura NB-IoT (CE0/1/2 por MCL).
+ */
+
+#ifndef LPWAN_LINK_BUDGET_H
+#define LPWAN_LINK_BUDGET_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace lpwan {
+
+// Sensibilidade do gateway LoRa (dBm) por SF, BW 125 kHz (SX1301)
+inline double GatewaySensitivityDbm(uint32_t sf) {
+    static const double table[] = {-130.0, -132.5, -135.0, -137.5, -140.0, -142.5};
+    return table[std::min<uint32_t>(std::max<uint32_t>(sf, 7), 12) - 7];
+}
+
+// Menor SF com potência recebida >= sensibilidade; 0 se nem SF12 alcança
+inline uint32_t MinimumLoraSf(double rxPowerDbm) {
+    for (uint32_t sf = 7; sf <= 12; ++sf) {
+        if (rxPowerDbm >= GatewaySensitivityDbm(sf)) {
+            return sf;
+        }
+    }
+    return 0;
+}
+
+// Classe de cobertura NB-IoT pelo acoplamento mínimo (MCL) em dB:
+// CE0 até 144, CE1 até 154, CE2 até 164; -1 fora de cobertura
+inline int NbIotCoverageClass(double mclDb) {
+    if (mclDb <= 144.0) {
+        return 0;
+    }
+    if (mclDb <= 154.0) {
+        return 1;
+    }
+    return mclDb <= 164.0 ? 2 : -1;
+}
+
+struct LinkBudgetParams {
+    double txPowerDbm = 14.0;
+    double pathLossExponent = 3.0;
+    double referenceDistance = 1.0; // m
+    double referenceLossDb = 46.6777;
+    double noiseFloorDbm = -117.0;  // -174 + 10 log10(BW) + NF (125 kHz, 6 dB)
+};
+
+class LinkBudgetTable {
+public:
+    // xs/ys/zs: arrays contíguos de posições (ex.: os vetores de Placement)
+    void Build(const LinkBudgetParams& p, const double* devX, const double* devY, const double* devZ,
+               uint32_t devices, const double* gwX, const double* gwY, const double* gwZ, uint32_t gateways) {
+        m_params = p;
+        m_devices = devices;
+        m_gateways = gateways;
+        m_rssi.assign(size_t(devices) * gateways, 0.0f);
+
+        const float tx = static_cast<float>(p.txPowerDbm);
+        const float refLoss = static_cast<float>(p.referenceLossDb);
+        const float ref2 = static_cast<float>(p.referenceDistance * p.referenceDistance);
+        const float k = static_cast<float>(5.0 * p.pathLossExponent); // 10 n log10(d) = 5 n log10(d²)
+        for (uint32_t g = 0; g < gateways; ++g) {
+            const float gx = static_cast<float>(gwX[g]);
+            const float gy = static_cast<float>(gwY[g]);
+            const float gz = static_cast<float>(gwZ[g]);
+            float* row = &m_rssi[size_t(g) * devices];
+            for (uint32_t d = 0; d < devices; ++d) {
+                float dx = static_cast<float>(devX[d]) - gx;
+                float dy = static_cast<float>(devY[d]) - gy;
+                float dz = static_cast<float>(devZ[d]) - gz;
+                float ratio = std::max((dx * dx + dy * dy + dz * dz) / ref2, 1.0f);
+                row[d] = tx - refLoss - k * std::log10(ratio);
+            }
+        }
+
+        m_best.assign(devices, 0);
+        for (uint32_t g = 1; g < gateways; ++g) {
+            const float* row = &m_rssi[size_t(g) * devices];
+            for (uint32_t d = 0; d < devices; ++d) {
+                if (row[d] > m_rssi[size_t(m_best[d]) * devices + d]) {
+                    m_best[d] = g;
+                }
+            }
+        }
+    }
+
+    uint32_t GetNDevices() const { return m_devices; }
+    uint32_t GetNGateways() const { return m_gateways; }
+
+    double Rssi(uint32_t dev, uint32_t gw) const { return m_rssi[size_t(gw) * m_devices + dev]; }
+    double Snr(uint32_t dev, uint32_t gw) const { return Rssi(dev, gw) - m_params.noiseFloorDbm; }
+
+    // Potência recebida com outra potência de transmissão (perda é a mesma)
+    double RxPower(uint32_t dev, uint32_t gw, double txPowerDbm) const {
+        return Rssi(dev, gw) + (txPowerDbm - m_params.txPowerDbm);
+    }
+
+    uint32_t BestGateway(uint32_t dev) const { return m_best[dev]; }
+    double BestRssi(uint32_t dev) const { return m_gateways ? Rssi(dev, m_best[dev]) : -std::numeric_limits<double>::infinity(); }
+
+    uint32_t MinSf(uint32_t dev) const { return MinimumLoraSf(BestRssi(dev)); }
+    int CoverageClass(uint32_t dev) const { return NbIotCoverageClass(m_params.txPowerDbm - BestRssi(dev)); }
+
+    // Quantos dispositivos em cada SF (índices 7..12; 0 = sem enlace)
+    std::vector<uint32_t> SfHistogram() const {
+        std::vector<uint32_t> hist(13, 0);
+        for (uint32_t d = 0; d < m_devices; ++d) {
+            hist[MinSf(d)]++;
+        }
+        return hist;
+    }
+
+private:
+    LinkBudgetParams m_params;
+    uint32_t m_devices = 0;
+    uint32_t m_gateways = 0;
+    std::vector<float> m_rssi;
+    std::vector<uint32_t> m_best;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_LINK_BUDGET_H
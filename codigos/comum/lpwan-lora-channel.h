@@ -0,0 +1,188 @@
+/*
+ * LoraChannel do lorawan-test: entrega por alcance e rastreio de interferência
+ *
+ * O LoraChannel original entrega cada transmissão a todos os PHYs do canal
+ * (end devices inclusive), custo O(N + G) por envio. Aqui o uplink de um end
+ * device vai só aos gateways na sua lista de alcance: os gateways cuja
+ * potência recebida fica acima de reachFloorDbm (abaixo da sensibilidade do
+ * SF12, então quem fica de fora não seria decodificado nem pesaria como
+ * interferência). A lista de cada transmissor é montada na primeira
+ * transmissão, consultando uma grade espacial de gateways com célula igual
+ * ao alcance máximo, e reaproveitada depois (nós fixos, potência de
+ * transmissão fixa, sem ADR). O custo por envio cresce com os gateways ao
+ * alcance, não com o total. Downlinks de gateway seguem pelo canal original.
+ * A potência de cada par da lista também fica guardada; com SetLinkBudget()
+ * as listas de todos os dispositivos saem de uma LinkBudgetTable calculada
+ * em lote, e nenhum envio consulta o modelo de perda.
+ *
+ * Cada entrega também alimenta o InterferenceTracker (uma entrada por
+ * gateway, com a potência que chega a ele). Os instantes são os do
+ * transmissor: o atraso de propagação sorteado não entra no rastreador, que
+ * é uma estimativa da disputa pelo meio; as perdas efetivas por causa vêm
+ * dos traces do PHY do gateway. Como um gateway fora da lista nunca recebe o
+ * uplink, o trace LostPacketBecauseUnderSensitivity dele não dispara; o canal
+ * conta esses pares (uplink, gateway) e AddTo() os soma às perdas por
+ * sensibilidade.
+ */
+
+#ifndef LPWAN_LORA_CHANNEL_H
+#define LPWAN_LORA_CHANNEL_H
+
+#include "lpwan-interference.h"
+#include "lpwan-link-budget.h"
+#include "lpwan-spatial-grid.h"
+
+#include "ns3/lora-channel.h"
+#include "ns3/simulator.h"
+
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace lpwan {
+
+class TrackedLoraChannel : public ns3::lorawan::LoraChannel {
+public:
+    static ns3::TypeId GetTypeId() {
+        static ns3::TypeId tid = ns3::TypeId("lpwan::TrackedLoraChannel")
+                                     .SetParent<ns3::lorawan::LoraChannel>()
+                                     .SetGroupName("lorawan");
+        return tid;
+    }
+
+    TrackedLoraChannel(ns3::Ptr<ns3::PropagationLossModel> loss, ns3::Ptr<ns3::PropagationDelayModel> delay)
+        : ns3::lorawan::LoraChannel(loss, delay),
+          m_loss(loss),
+          m_delay(delay) {}
+
+    void SetTracker(InterferenceTracker* tracker) { m_tracker = tracker; }
+
+    // Potência mínima para um uplink chegar a um gateway (padrão: 3 dB
+    // abaixo da sensibilidade do SF12)
+    void SetReachFloor(double dbm) {
+        m_reachFloorDbm = dbm;
+        m_reach.clear();
+    }
+
+    // Gateways que recebem uplink (o índice vira parte da chave do rastreador)
+    void AddGateway(ns3::Ptr<ns3::lorawan::LoraPhy> phy) {
+        m_gateways.push_back(phy);
+        m_gatewaySet.insert(ns3::PeekPointer(phy));
+        m_reach.clear();
+        m_gridBuilt = false;
+    }
+
+    uint32_t GetNGateways() const { return m_gateways.size(); }
+
+    // Monta as listas de alcance a partir da tabela: linha d = devices[d],
+    // coluna g = g-ésimo AddGateway(). Chamar depois de todos os AddGateway().
+    void SetLinkBudget(const LinkBudgetTable& table, const std::vector<ns3::Ptr<ns3::lorawan::LoraPhy>>& devices,
+                       double txPowerDbm) {
+        m_reach.clear();
+        m_outOfReach = 0;
+        for (uint32_t d = 0; d < devices.size(); ++d) {
+            ReachList& reach = m_reach[ns3::PeekPointer(devices[d])];
+            for (uint32_t g = 0; g < table.GetNGateways(); ++g) {
+                double rx = table.RxPower(d, g, txPowerDbm);
+                if (rx >= m_reachFloorDbm) {
+                    reach.gateways.push_back(g);
+                    reach.rxDbm.push_back(rx);
+                }
+            }
+        }
+    }
+
+    // Média de gateways ao alcance por transmissor com lista montada
+    double GetMeanReach() const {
+        uint64_t total = 0;
+        for (const auto& entry : m_reach) {
+            total += entry.second.gateways.size();
+        }
+        return m_reach.empty() ? 0.0 : double(total) / m_reach.size();
+    }
+
+    // Pares (uplink, gateway) fora do alcance desde o último SetLinkBudget():
+    // perdas por sensibilidade que o PHY do gateway não chega a ver
+    void AddTo(LossBreakdown& b) const { b.underSensitivity += m_outOfReach; }
+
+    void Send(ns3::Ptr<ns3::lorawan::LoraPhy> sender, ns3::Ptr<ns3::Packet> packet, double txPowerDbm,
+              ns3::lorawan::LoraTxParameters txParams, ns3::Time duration, double frequencyMHz) const override {
+        if (m_gatewaySet.count(ns3::PeekPointer(sender)) > 0) {
+            ns3::lorawan::LoraChannel::Send(sender, packet, txPowerDbm, txParams, duration, frequencyMHz);
+            return;
+        }
+
+        ns3::Ptr<ns3::MobilityModel> senderMobility = sender->GetMobility();
+        double start = ns3::Simulator::Now().GetSeconds();
+        const ReachList& reach = Reach(sender, txPowerDbm);
+        m_outOfReach += m_gateways.size() - reach.gateways.size();
+        for (uint32_t i = 0; i < reach.gateways.size(); ++i) {
+            uint32_t g = reach.gateways[i];
+            const ns3::Ptr<ns3::lorawan::LoraPhy>& gateway = m_gateways[g];
+            ns3::Ptr<ns3::MobilityModel> gatewayMobility = gateway->GetMobility();
+            double rx = reach.rxDbm[i];
+            if (m_tracker) {
+                m_tracker->Start(InterferenceTracker::MakeKey(g, frequencyMHz, txParams.sf), start,
+                                 start + duration.GetSeconds(), rx);
+            }
+            ns3::Time delay = m_delay->GetDelay(senderMobility, gatewayMobility);
+            ns3::Simulator::ScheduleWithContext(gateway->GetDevice()->GetNode()->GetId(), delay,
+                                                &ns3::lorawan::LoraPhy::StartReceive, gateway, packet->Copy(), rx,
+                                                txParams.sf, duration, frequencyMHz);
+        }
+    }
+
+private:
+    // Gateways ao alcance de um transmissor e a potência que chega a cada um
+    struct ReachList {
+        std::vector<uint32_t> gateways;
+        std::vector<double> rxDbm;
+    };
+
+    // Lista de gateways ao alcance do transmissor (montada uma vez)
+    const ReachList& Reach(ns3::Ptr<ns3::lorawan::LoraPhy> sender, double txPowerDbm) const {
+        auto it = m_reach.find(ns3::PeekPointer(sender));
+        if (it != m_reach.end()) {
+            return it->second;
+        }
+        if (!m_gridBuilt) {
+            BuildGrid(txPowerDbm);
+        }
+        ReachList& reach = m_reach[ns3::PeekPointer(sender)];
+        ns3::Ptr<ns3::MobilityModel> mobility = sender->GetMobility();
+        ns3::Vector pos = mobility->GetPosition();
+        m_gatewayGrid.ForEachNear(pos.x, pos.y, [&](uint32_t g) {
+            double rx = GetRxPower(txPowerDbm, mobility, m_gateways[g]->GetMobility());
+            if (rx >= m_reachFloorDbm) {
+                reach.gateways.push_back(g);
+                reach.rxDbm.push_back(rx);
+            }
+        });
+        return reach;
+    }
+
+    void BuildGrid(double txPowerDbm) const {
+        m_gatewayGrid.Reset(ComputeMaxRange(m_loss, txPowerDbm, m_reachFloorDbm));
+        for (uint32_t g = 0; g < m_gateways.size(); ++g) {
+            ns3::Vector pos = m_gateways[g]->GetMobility()->GetPosition();
+            m_gatewayGrid.Insert(g, pos.x, pos.y);
+        }
+        m_gridBuilt = true;
+    }
+
+    ns3::Ptr<ns3::PropagationLossModel> m_loss;
+    ns3::Ptr<ns3::PropagationDelayModel> m_delay;
+    InterferenceTracker* m_tracker = nullptr;
+    double m_reachFloorDbm = -145.5;
+    std::vector<ns3::Ptr<ns3::lorawan::LoraPhy>> m_gateways;
+    std::set<const ns3::lorawan::LoraPhy*> m_gatewaySet;
+    mutable std::unordered_map<const ns3::lorawan::LoraPhy*, ReachList> m_reach;
+    mutable SpatialGrid m_gatewayGrid;
+    mutable bool m_gridBuilt = false;
+    mutable uint64_t m_outOfReach = 0;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_LORA_CHANNEL_H
@@ -0,0 +1,114 @@
+/*
+ * Métricas por dispositivo em estrutura de arrays (SoA)
+ *
+ * Substitui os contadores globais soltos dos simuladores. Cada métrica é um
+ * vetor contíguo indexado pelo índice do dispositivo (0..N-1), dimensionado
+ * uma única vez em Reset(); os callbacks de trace só fazem incrementos e não
+ * alocam memória. Os totais da execução saem de Aggregate() ao final.
+ * A associação pacote -> dispositivo fica em lpwan-uid-tracker.h.
+ *
+ * Além da soma, cada atraso entra no histograma de memória fixa da classe
+ * do dispositivo (SetLatencyClasses / SetClass; sem classes, só o geral).
+ */
+
+#ifndef LPWAN_METRICS_H
+#define LPWAN_METRICS_H
+
+#include "lpwan-latency-histogram.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace lpwan {
+
+// Totais agregados de uma execução
+struct MetricsTotals {
+    uint64_t tx;
+    uint64_t rx;
+    uint64_t duplicates;
+    uint64_t bytesReceived;
+    double delaySum; // s
+    double delayMin; // s
+    double delayMax; // s
+    double energy;   // J
+};
+
+class MetricsStore {
+public:
+    // Dimensiona e zera os vetores para nDevices dispositivos
+    void Reset(uint32_t nDevices) {
+        m_tx.assign(nDevices, 0);
+        m_rx.assign(nDevices, 0);
+        m_duplicates.assign(nDevices, 0);
+        m_bytes.assign(nDevices, 0);
+        m_delaySum.assign(nDevices, 0.0);
+        m_delayMin.assign(nDevices, std::numeric_limits<double>::infinity());
+        m_delayMax.assign(nDevices, 0.0);
+        m_energy.assign(nDevices, 0.0);
+        m_class.assign(nDevices, 0);
+        m_latency.Reset();
+    }
+
+    // Nomes das classes de dispositivo do histograma de atraso (depois do
+    // Reset); todos começam na classe 0
+    void SetLatencyClasses(const std::vector<std::string>& names) { m_latency.Reset(names); }
+    void SetClass(uint32_t dev, uint8_t cls) { m_class[dev] = cls; }
+
+    uint32_t GetN() const { return static_cast<uint32_t>(m_tx.size()); }
+
+    void RecordTx(uint32_t dev) { m_tx[dev]++; }
+
+    void RecordRx(uint32_t dev, uint32_t bytes, double delay) {
+        m_rx[dev]++;
+        m_bytes[dev] += bytes;
+        m_delaySum[dev] += delay;
+        m_delayMin[dev] = std::min(m_delayMin[dev], delay);
+        m_delayMax[dev] = std::max(m_delayMax[dev], delay);
+        m_latency.Record(m_class[dev], delay);
+    }
+
+    void RecordDuplicate(uint32_t dev) { m_duplicates[dev]++; }
+
+    void AddEnergy(uint32_t dev, double joules) { m_energy[dev] += joules; }
+
+    uint32_t GetTx(uint32_t dev) const { return m_tx[dev]; }
+    uint32_t GetRx(uint32_t dev) const { return m_rx[dev]; }
+    double GetEnergy(uint32_t dev) const { return m_energy[dev]; }
+    const LatencyReport& GetLatency() const { return m_latency; }
+
+    MetricsTotals Aggregate() const {
+        MetricsTotals t{0, 0, 0, 0, 0.0, 0.0, 0.0, 0.0};
+        double delayMin = std::numeric_limits<double>::infinity();
+        for (uint32_t i = 0; i < GetN(); ++i) {
+            t.tx += m_tx[i];
+            t.rx += m_rx[i];
+            t.duplicates += m_duplicates[i];
+            t.bytesReceived += m_bytes[i];
+            t.delaySum += m_delaySum[i];
+            t.energy += m_energy[i];
+            delayMin = std::min(delayMin, m_delayMin[i]);
+            t.delayMax = std::max(t.delayMax, m_delayMax[i]);
+        }
+        t.delayMin = (t.rx > 0) ? delayMin : 0.0;
+        return t;
+    }
+
+private:
+    std::vector<uint32_t> m_tx;
+    std::vector<uint32_t> m_rx;
+    std::vector<uint32_t> m_duplicates;
+    std::vector<uint64_t> m_bytes;
+    std::vector<double> m_delaySum;
+    std::vector<double> m_delayMin;
+    std::vector<double> m_delayMax;
+    std::vector<double> m_energy;
+    std::vector<uint8_t> m_class;
+    LatencyReport m_latency;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_METRICS_H
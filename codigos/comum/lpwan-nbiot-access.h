@@ -0,0 +1,240 @@
+/*
+ * Modelo de acesso NB-IoT de fidelidade reduzida
+ *
+ * Alternativa à pilha LTE/EPC completa do nb-iot-sim para as densidades da
+ * grade estendida (10000-50000 UEs). Não há nós, IP nem RRC; cada relatório
+ * passa por:
+ *   - classe de cobertura (CE0/1/2) pelo MCL do orçamento de enlace
+ *     (LinkBudgetTable); fora de cobertura o relatório é perdido;
+ *   - NPRACH: a cada oportunidade do nível de CE (período próprio), cada UE
+ *     sorteia uma das subportadoras do nível; duas ou mais escolhas iguais
+ *     colidem. Quem colide espera a janela de RAR e um backoff uniforme e
+ *     tenta de novo, até maxAttempts (depois o relatório é perdido). O
+ *     preâmbulo dura repetições × 5,6 ms (formato 0);
+ *   - NPUSCH: o escalonador divide os 180 kHz em 12 subportadoras de 15 kHz
+ *     e dá a cada UE o grupo alinhado de `tones` subportadoras livre mais
+ *     cedo (12/6/3/1 tons -> unidades de recurso de 1/2/4/8 ms), por
+ *     ceil(bits / bits por RU) × repetições unidades.
+ * Os valores por nível de CE são aproximações típicas de implantação, não
+ * uma configuração de operadora.
+ *
+ * Eventos: um por relatório (tráfego), um por oportunidade NPRACH com
+ * tentativas e um por entrega. UEs sem relatório pendente não custam nada;
+ * a energia vai para o NbIotPowerSaving (PSM/eDRX sem eventos).
+ */
+
+#ifndef LPWAN_NBIOT_ACCESS_H
+#define LPWAN_NBIOT_ACCESS_H
+
+#include "lpwan-link-budget.h"
+#include "lpwan-nbiot-psm.h"
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lpwan {
+
+static const uint32_t NBIOT_CE_LEVELS = 3;
+static const uint32_t NBIOT_SUBCARRIERS = 12;
+
+struct NbIotAccessConfig {
+    double nprachPeriod[NBIOT_CE_LEVELS] = {0.04, 0.08, 0.16}; // s
+    uint32_t nprachSubcarriers[NBIOT_CE_LEVELS] = {24, 12, 12};
+    uint32_t nprachRepetitions[NBIOT_CE_LEVELS] = {1, 8, 32};
+    uint32_t npuschTones[NBIOT_CE_LEVELS] = {12, 3, 1};
+    uint32_t npuschRepetitions[NBIOT_CE_LEVELS] = {1, 4, 16};
+    uint32_t bitsPerRu[NBIOT_CE_LEVELS] = {256, 120, 32};
+    uint32_t maxAttempts = 10;
+    double rarWindow = 0.01;      // s, espera pela resposta de acesso aleatório
+    double backoffWindow = 0.256; // s, backoff uniforme em [0, backoffWindow]
+    double txPowerDbm = 23.0;
+};
+
+// Contadores do acesso (além das métricas por UE)
+struct NbIotAccessStats {
+    uint64_t preambles = 0;
+    uint64_t collisions = 0;     // preâmbulos colididos
+    uint64_t accessFailures = 0; // relatórios perdidos após maxAttempts
+    uint64_t outOfCoverage = 0;  // relatórios de UEs sem classe de CE
+    uint64_t uesPerCe[NBIOT_CE_LEVELS] = {0, 0, 0};
+    double toneSeconds = 0.0;    // subportadoras × s ocupados no NPUSCH
+};
+
+class NbIotAccessModel {
+public:
+    using DeliverCallback = std::function<void(uint32_t ue, double sendTime)>;
+
+    NbIotAccessModel() : m_uniform(ns3::CreateObject<ns3::UniformRandomVariable>()) {}
+
+    // Fluxo fixo do RNG (subportadora e backoff); devolve quantos usou
+    int64_t AssignStreams(int64_t stream) {
+        m_uniform->SetStream(stream);
+        return 1;
+    }
+
+    // Classes de CE a partir da tabela (coluna 0 = eNB); psm pode ser nulo
+    void Install(const NbIotAccessConfig& config, const LinkBudgetTable& table, NbIotPowerSaving* psm,
+                 DeliverCallback deliver) {
+        m_config = config;
+        m_psm = psm;
+        m_deliver = deliver;
+        m_stats = NbIotAccessStats{};
+        uint32_t ues = table.GetNDevices();
+        m_ce.resize(ues);
+        for (uint32_t ue = 0; ue < ues; ++ue) {
+            m_ce[ue] = static_cast<int8_t>(table.CoverageClass(ue));
+            if (m_ce[ue] >= 0) {
+                m_stats.uesPerCe[m_ce[ue]]++;
+            }
+        }
+        m_queue.assign(ues, std::vector<double>());
+        m_attempt.assign(ues, 0);
+        m_freeAt.assign(NBIOT_SUBCARRIERS, 0.0);
+        m_pending.clear();
+    }
+
+    // Bits por relatório no NPUSCH (payload + cabeçalhos)
+    void SetPayloadBits(double bits) { m_payloadBits = bits; }
+
+    const NbIotAccessStats& GetStats() const { return m_stats; }
+    int GetCoverageClass(uint32_t ue) const { return m_ce[ue]; }
+
+    // Novo relatório do UE no instante atual
+    void Report(uint32_t ue) {
+        if (m_ce[ue] < 0) {
+            m_stats.outOfCoverage++;
+            return;
+        }
+        m_queue[ue].push_back(Now());
+        if (m_queue[ue].size() == 1) {
+            m_attempt[ue] = 0;
+            Attempt(ue);
+        }
+    }
+
+private:
+    static double Now() { return ns3::Simulator::Now().GetSeconds(); }
+
+    double PreambleDuration(uint32_t ce) const { return m_config.nprachRepetitions[ce] * 0.0056; }
+
+    // Próxima oportunidade NPRACH do nível: sorteia a subportadora e entra
+    // na lista da oportunidade (a primeira tentativa agenda a resolução)
+    void Attempt(uint32_t ue) {
+        uint32_t ce = m_ce[ue];
+        uint64_t k = static_cast<uint64_t>(std::ceil(Now() / m_config.nprachPeriod[ce]));
+        double opportunity = k * m_config.nprachPeriod[ce];
+        uint32_t subcarrier = m_uniform->GetInteger(0, m_config.nprachSubcarriers[ce] - 1);
+        m_attempt[ue]++;
+        m_stats.preambles++;
+        if (m_psm) {
+            m_psm->Activity(ue, opportunity, RADIO_TX, PreambleDuration(ce), TxLevel());
+        }
+
+        uint64_t key = k * NBIOT_CE_LEVELS + ce;
+        std::vector<std::pair<uint32_t, uint32_t>>& list = m_pending[key];
+        if (list.empty()) {
+            ns3::Simulator::Schedule(ns3::Seconds(opportunity + PreambleDuration(ce) - Now()),
+                                     &NbIotAccessModel::Resolve, this, key);
+        }
+        list.emplace_back(subcarrier, ue);
+    }
+
+    void Resolve(uint64_t key) {
+        std::vector<std::pair<uint32_t, uint32_t>> list = std::move(m_pending[key]);
+        m_pending.erase(key);
+        std::sort(list.begin(), list.end());
+        for (size_t i = 0; i < list.size();) {
+            size_t j = i;
+            while (j < list.size() && list[j].first == list[i].first) {
+                ++j;
+            }
+            for (size_t n = i; n < j; ++n) {
+                if (j - i == 1) {
+                    Grant(list[n].second);
+                } else {
+                    m_stats.collisions++;
+                    Backoff(list[n].second);
+                }
+            }
+            i = j;
+        }
+    }
+
+    void Backoff(uint32_t ue) {
+        if (m_psm) {
+            m_psm->Activity(ue, Now(), RADIO_RX, m_config.rarWindow, 0);
+        }
+        if (m_attempt[ue] >= m_config.maxAttempts) {
+            m_stats.accessFailures++;
+            Next(ue);
+            return;
+        }
+        double wait = m_config.rarWindow + m_uniform->GetValue(0.0, m_config.backoffWindow);
+        ns3::Simulator::Schedule(ns3::Seconds(wait), &NbIotAccessModel::Attempt, this, ue);
+    }
+
+    // Acesso aceito: grupo de tons livre mais cedo, transmissão e entrega
+    void Grant(uint32_t ue) {
+        uint32_t ce = m_ce[ue];
+        uint32_t tones = m_config.npuschTones[ce];
+        uint32_t best = 0;
+        double bestFree = 1e300;
+        for (uint32_t g = 0; g < NBIOT_SUBCARRIERS; g += tones) {
+            double at = *std::max_element(&m_freeAt[g], &m_freeAt[g] + tones);
+            if (at < bestFree) {
+                bestFree = at;
+                best = g;
+            }
+        }
+        static const double ruDuration[13] = {0, 0.008, 0, 0.004, 0, 0, 0.002, 0, 0, 0, 0, 0, 0.001};
+        double bits = m_payloadBits;
+        double units = std::ceil(bits / m_config.bitsPerRu[ce]) * m_config.npuschRepetitions[ce];
+        double duration = units * ruDuration[tones];
+        double start = std::max(Now() + m_config.rarWindow, bestFree);
+        std::fill(&m_freeAt[best], &m_freeAt[best] + tones, start + duration);
+        m_stats.toneSeconds += duration * tones;
+        if (m_psm) {
+            m_psm->Activity(ue, start, RADIO_TX, duration, TxLevel());
+        }
+        ns3::Simulator::Schedule(ns3::Seconds(start + duration - Now()), &NbIotAccessModel::Delivered, this, ue);
+    }
+
+    void Delivered(uint32_t ue) {
+        m_deliver(ue, m_queue[ue].front());
+        Next(ue);
+    }
+
+    // Próximo relatório da fila do UE
+    void Next(uint32_t ue) {
+        m_queue[ue].erase(m_queue[ue].begin());
+        if (!m_queue[ue].empty()) {
+            m_attempt[ue] = 0;
+            Attempt(ue);
+        }
+    }
+
+    uint8_t TxLevel() const { return m_psm ? m_psm->GetLog()->GetProfile().TxLevel(m_config.txPowerDbm) : 0; }
+
+    NbIotAccessConfig m_config;
+    NbIotPowerSaving* m_psm = nullptr;
+    DeliverCallback m_deliver;
+    NbIotAccessStats m_stats;
+    double m_payloadBits = 50 * 8;
+    std::vector<int8_t> m_ce;
+    std::vector<std::vector<double>> m_queue; // instantes dos relatórios pendentes
+    std::vector<uint32_t> m_attempt;
+    std::vector<double> m_freeAt;             // s, por subportadora do NPUSCH
+    std::unordered_map<uint64_t, std::vector<std::pair<uint32_t, uint32_t>>> m_pending; // (subportadora, UE)
+    ns3::Ptr<ns3::UniformRandomVariable> m_uniform;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_NBIOT_ACCESS_H
@@ -0,0 +1,132 @@
+/*
+ * Economia de energia NB-IoT (PSM / eDRX) sem eventos entre relatórios
+ *
+ * Depois de cada atividade (envio ou recepção) o UE segue a linha do tempo
+ * dos temporizadores do 3GPP:
+ *   - conectado até o temporizador de inatividade do RRC;
+ *   - idle por T3324 (active timer), acordando a cada ciclo de eDRX (ou de
+ *     DRX, sem eDRX) para as ocasiões de paging da janela PTW;
+ *   - PSM até a próxima atividade ou até T3412 (TAU periódico) vencer, quando
+ *     faz um TAU (TX + RX curtos) e recomeça o ciclo.
+ * Nada disso agenda eventos: a linha do tempo de cada UE é reconstruída só
+ * quando a próxima atividade chega (ou em Finish(), no fim da execução) e
+ * vai direto para o RadioEnergyLog, com as ocasiões de paging somadas em
+ * lote (RadioEnergyLog::DutyCycle). UEs dormindo custam zero eventos; o
+ * único evento por UE é o próprio relatório.
+ *
+ * Com enabled = false o UE só fica conectado até a inatividade e depois
+ * dorme (o modelo anterior, sem paging nem TAU).
+ */
+
+#ifndef LPWAN_NBIOT_PSM_H
+#define LPWAN_NBIOT_PSM_H
+
+#include "lpwan-radio-energy.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace lpwan {
+
+struct PsmConfig {
+    bool enabled = false;
+    double rrcInactivity = 20.0;     // s, conectado após a última atividade
+    double t3324 = 60.0;             // s, active timer (idle com paging)
+    double t3412 = 3240.0;           // s, TAU periódico (54 min, padrão do 3GPP)
+    double edrxCycle = 20.48;        // s, 0 = sem eDRX (paging a cada drxCycle)
+    double ptw = 2.56;               // s, janela de paging em cada ciclo de eDRX
+    double drxCycle = 1.28;          // s, ciclo de paging dentro da PTW
+    double pagingOccasion = 0.01;    // s de RX por ocasião de paging
+    double tauDuration = 0.05;       // s de TX (e o mesmo de RX) por TAU
+
+    // RX por ciclo de paging e período do ciclo
+    double PagingOnTime() const {
+        if (edrxCycle <= 0.0) {
+            return pagingOccasion;
+        }
+        return std::max(1.0, std::floor(ptw / drxCycle)) * pagingOccasion;
+    }
+    double PagingPeriod() const { return edrxCycle > 0.0 ? edrxCycle : drxCycle; }
+
+    // Identificação para o hash da configuração
+    std::string Describe() const {
+        std::ostringstream ss;
+        ss << "t3324=" << t3324 << ",t3412=" << t3412 << ",edrx=" << edrxCycle << ",ptw=" << ptw;
+        return ss.str();
+    }
+};
+
+class NbIotPowerSaving {
+public:
+    // O log já deve estar dimensionado (Reset) para os `ues` UEs
+    void Reset(const PsmConfig& config, RadioEnergyLog* log, uint32_t ues, double start = 0.0) {
+        m_config = config;
+        m_log = log;
+        m_lastActivity.assign(ues, start);
+        m_lastTau.assign(ues, start);
+        m_taus = 0;
+    }
+
+    const PsmConfig& GetConfig() const { return m_config; }
+    RadioEnergyLog* GetLog() const { return m_log; }
+    uint64_t GetTauCount() const { return m_taus; }
+
+    // Atividade de `duration` segundos em `state` a partir de `now`; o UE
+    // volta a conectado no fim
+    void Activity(uint32_t ue, double now, uint8_t state, double duration, uint8_t txLevel) {
+        Replay(ue, now);
+        m_log->Burst(ue, now, duration, state, txLevel, RADIO_IDLE);
+        m_lastActivity[ue] = now + duration;
+        m_lastTau[ue] = now; // qualquer conexão reinicia o T3412
+    }
+
+    // Fecha a linha do tempo de todos os UEs em `until` (fim da execução)
+    void Finish(double until) {
+        for (uint32_t ue = 0; ue < m_lastActivity.size(); ++ue) {
+            Replay(ue, until);
+        }
+    }
+
+private:
+    // Reconstrói, a partir da última atividade, os estados até `t`
+    void Replay(uint32_t ue, double t) {
+        double cursor = m_lastActivity[ue];
+        for (;;) {
+            double release = cursor + m_config.rrcInactivity;
+            if (t <= release) {
+                return;
+            }
+            if (!m_config.enabled) {
+                m_log->SetState(ue, release, RADIO_SLEEP);
+                return;
+            }
+            double idleEnd = release + m_config.t3324;
+            m_log->DutyCycle(ue, release, std::min(idleEnd, t), RADIO_RX, m_config.PagingOnTime(),
+                             m_config.PagingPeriod());
+            double tau = m_lastTau[ue] + m_config.t3412;
+            if (t <= idleEnd || t <= tau || m_config.t3412 <= 0.0) {
+                return; // PSM (SLEEP) até t
+            }
+            uint8_t level = m_log->GetProfile().txLevels - 1;
+            tau = std::max(tau, idleEnd);
+            m_log->Burst(ue, tau, m_config.tauDuration, RADIO_TX, level, RADIO_RX);
+            m_log->SetState(ue, tau + 2 * m_config.tauDuration, RADIO_IDLE);
+            m_lastTau[ue] = tau;
+            m_lastActivity[ue] = cursor = tau + 2 * m_config.tauDuration;
+            m_taus++;
+        }
+    }
+
+    PsmConfig m_config;
+    RadioEnergyLog* m_log = nullptr;
+    std::vector<double> m_lastActivity; // s, fim da última atividade (ou TAU)
+    std::vector<double> m_lastTau;      // s, último instante que reiniciou o T3412
+    uint64_t m_taus = 0;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_NBIOT_PSM_H
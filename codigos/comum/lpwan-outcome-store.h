@@ -0,0 +1,144 @@
+/*
+ * Resultado das repetições Sigfox em bits
+ *
+ * Substitui o vector<vector<vector<bool>>> do simulador Sigfox. Cada
+ * mensagem (dispositivo, número do pacote) ocupa um byte numa matriz de
+ * layout fixo, dimensionada uma vez em Reset():
+ *   bits 0-2: repetição r recebida pelo gateway
+ *   bits 3-5: repetição r observada (recebida ou perdida)
+ *   bit  6:   mensagem fora da janela de medição (não conta)
+ * Uma mensagem é entregue se qualquer repetição chegou. As contagens usam
+ * SWAR em palavras de 64 bits (8 mensagens por palavra) e popcount sobre a
+ * linha contígua de cada dispositivo; com 50k dispositivos e dias de
+ * tráfego a matriz ocupa um byte por mensagem.
+ *
+ * O número do pacote na SigfoxTag tem 8 bits e dá a volta a cada 256
+ * mensagens; UnwrapPacketNumber() reconstrói o índice a partir de uma
+ * estimativa (instante / período).
+ */
+
+#ifndef LPWAN_OUTCOME_STORE_H
+#define LPWAN_OUTCOME_STORE_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace lpwan {
+
+// Índice completo do pacote cujo número de 8 bits é `number`, o mais
+// próximo de `estimate`
+inline uint64_t UnwrapPacketNumber(uint8_t number, double estimate) {
+    double k = std::round((estimate - number) / 256.0);
+    return k > 0 ? uint64_t(k) * 256 + number : number;
+}
+
+struct OutcomeCount {
+    uint64_t successes = 0;
+    uint64_t failures = 0;
+
+    uint64_t Total() const { return successes + failures; }
+    double Ratio() const { return Total() > 0 ? double(successes) / Total() : 0.0; }
+};
+
+class OutcomeStore {
+public:
+    static const uint32_t MAX_REPETITIONS = 3;
+
+    void Reset(uint32_t devices, uint32_t packetsPerDevice) {
+        m_devices = devices;
+        m_packets = packetsPerDevice;
+        m_stride = (packetsPerDevice + 7) / 8 * 8; // linha alinhada a 8 bytes
+        m_cells.assign(size_t(devices) * m_stride, 0);
+        m_dropped = 0;
+    }
+
+    uint32_t GetNDevices() const { return m_devices; }
+    uint32_t GetNPackets() const { return m_packets; }
+
+    // Mensagens ignoradas por estarem além de packetsPerDevice
+    uint64_t GetDropped() const { return m_dropped; }
+
+    // Registra uma repetição. `counted` só vale na primeira observação da
+    // mensagem (as demais repetições herdam a decisão)
+    void Set(uint32_t dev, uint64_t packet, uint32_t repetition, bool received, bool counted = true) {
+        if (dev >= m_devices || packet >= m_packets || repetition >= MAX_REPETITIONS) {
+            m_dropped++;
+            return;
+        }
+        uint8_t& cell = m_cells[size_t(dev) * m_stride + packet];
+        if (cell == 0 && !counted) {
+            cell = EXCLUDED;
+        }
+        cell |= uint8_t(1u << (repetition + MAX_REPETITIONS));
+        if (received) {
+            cell |= uint8_t(1u << repetition);
+        }
+    }
+
+    OutcomeCount Count() const { return Count(0, m_devices, 0, m_packets); }
+
+    OutcomeCount CountDevice(uint32_t dev) const { return Count(dev, dev + 1, 0, m_packets); }
+
+    // Dispositivos [devBegin, devEnd) x pacotes [packetBegin, packetEnd)
+    OutcomeCount Count(uint32_t devBegin, uint32_t devEnd, uint32_t packetBegin, uint32_t packetEnd) const {
+        OutcomeCount c;
+        for (uint32_t dev = devBegin; dev < devEnd; ++dev) {
+            CountRange(&m_cells[size_t(dev) * m_stride], packetBegin, packetEnd, c);
+        }
+        return c;
+    }
+
+    // Taxa de entrega por janela de `packetsPerWindow` pacotes (com período
+    // fixo, uma janela de tempo), somando todos os dispositivos
+    std::vector<double> WindowRatios(uint32_t packetsPerWindow) const {
+        std::vector<double> ratios;
+        for (uint32_t p = 0; p < m_packets; p += packetsPerWindow) {
+            uint32_t end = p + packetsPerWindow < m_packets ? p + packetsPerWindow : m_packets;
+            ratios.push_back(Count(0, m_devices, p, end).Ratio());
+        }
+        return ratios;
+    }
+
+private:
+    static const uint8_t EXCLUDED = 1u << 6;
+    static const uint64_t LOW = 0x0101010101010101ULL;
+
+    // Soma entregues/perdidas de 8 células (SWAR)
+    static void CountWord(uint64_t w, OutcomeCount& c) {
+        uint64_t received = w & (LOW * 0x07);
+        received = (received | received >> 1 | received >> 2) & LOW;
+        uint64_t heard = (w >> MAX_REPETITIONS) & (LOW * 0x07);
+        heard = (heard | heard >> 1 | heard >> 2) & LOW;
+        uint64_t included = ~(w >> 6) & LOW;
+        uint64_t delivered = __builtin_popcountll(received & included);
+        c.successes += delivered;
+        c.failures += __builtin_popcountll(heard & included) - delivered;
+    }
+
+    static void CountRange(const uint8_t* row, uint32_t begin, uint32_t end, OutcomeCount& c) {
+        // Bordas desalinhadas byte a byte, meio em palavras de 64 bits
+        while (begin < end && begin % 8 != 0) {
+            CountWord(row[begin++], c);
+        }
+        for (; begin + 8 <= end; begin += 8) {
+            uint64_t w;
+            std::memcpy(&w, row + begin, sizeof(w));
+            CountWord(w, c);
+        }
+        while (begin < end) {
+            CountWord(row[begin++], c);
+        }
+    }
+
+    uint32_t m_devices = 0;
+    uint32_t m_packets = 0;
+    uint32_t m_stride = 0;
+    std::vector<uint8_t> m_cells; // [dispositivo][pacote]
+    uint64_t m_dropped = 0;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_OUTCOME_STORE_H
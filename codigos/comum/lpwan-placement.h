@@ -0,0 +1,216 @@
+/*
+ * Geração de posições dos dispositivos
+ *
+ * Substitui os ListPositionAllocator montados com um Add(Vector) por nó. As
+ * posições são geradas em vetores contíguos (x, y, z) com um gerador próprio
+ * semeado (mesma semente e execução -> mesmo layout) e instaladas criando o
+ * ConstantPositionMobilityModel de cada nó diretamente, sem alocador.
+ *
+ * Layouts (centro na origem, onde ficam o gateway / eNB):
+ *   - annulus: anel de raio `radius` e largura `width` (width = 0: todos
+ *              exatamente a `radius`, o cenário "distância" dos experimentos);
+ *   - disc:    uniforme no disco de raio `radius`;
+ *   - grid:    grade quadrada com lado `spacing`, centrada;
+ *   - hex:     rede hexagonal com lado `spacing`, em anéis a partir do centro;
+ *   - line:    x = radius, y = i * spacing (layout antigo das versões simplificadas);
+ *   - file:    CSV/texto "x y [z]" ou "x,y[,z]", ou binário (.bin) com
+ *              triplas de double (x, y, z) na ordem de bytes da máquina.
+ * Para o arquivo, `count` limita quantas posições são usadas (0 = todas).
+ */
+
+#ifndef LPWAN_PLACEMENT_H
+#define LPWAN_PLACEMENT_H
+
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lpwan {
+
+struct Placement {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+
+    uint32_t size() const { return x.size(); }
+
+    void resize(uint32_t n) {
+        x.assign(n, 0.0);
+        y.assign(n, 0.0);
+        z.assign(n, 0.0);
+    }
+
+    void push_back(double px, double py, double pz) {
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+    }
+};
+
+struct PlacementConfig {
+    std::string layout = "annulus"; // annulus | disc | grid | hex | line | file
+    uint32_t count = 0;
+    double radius = 1000.0;         // m
+    double width = 0.0;             // m, só annulus
+    double spacing = 10.0;          // m, grid / hex / line
+    std::string file;               // só file
+    uint64_t seed = 1;
+
+    // Layout padrão do simulador, sem largura, espaçamento nem arquivo
+    // alterados? Só fora do padrão o layout entra no hash da configuração
+    bool IsDefault(const std::string& defaultLayout) const {
+        return layout == defaultLayout && width == 0.0 && spacing == 10.0 && file.empty();
+    }
+
+    // Identificação para o hash da configuração (sem a semente)
+    std::string Describe() const {
+        std::ostringstream ss;
+        ss << layout << ":r=" << radius << ",w=" << width << ",s=" << spacing;
+        if (layout == "file") {
+            ss << ",f=" << file;
+        }
+        return ss.str();
+    }
+};
+
+// Semente do layout a partir da semente global e da execução (splitmix64)
+inline uint64_t PlacementSeed(uint64_t seed, uint64_t run) {
+    uint64_t z = seed * 0x9e3779b97f4a7c15ULL + run;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+inline Placement ReadPlacementFile(const std::string& path, uint32_t limit = 0) {
+    Placement p;
+    if (path.size() > 4 && path.compare(path.size() - 4, 4, ".bin") == 0) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) {
+            throw std::runtime_error("não foi possível abrir " + path);
+        }
+        double xyz[3];
+        while ((limit == 0 || p.size() < limit) && std::fread(xyz, sizeof(double), 3, f) == 3) {
+            p.push_back(xyz[0], xyz[1], xyz[2]);
+        }
+        std::fclose(f);
+    } else {
+        std::ifstream file(path);
+        if (!file) {
+            throw std::runtime_error("não foi possível abrir " + path);
+        }
+        std::string line;
+        while ((limit == 0 || p.size() < limit) && std::getline(file, line)) {
+            line = line.substr(0, line.find('#'));
+            std::replace(line.begin(), line.end(), ',', ' ');
+            std::istringstream fields(line);
+            double px, py, pz = 0.0;
+            if (fields >> px >> py) {
+                fields >> pz;
+                p.push_back(px, py, pz);
+            }
+        }
+    }
+    if (p.size() == 0) {
+        throw std::runtime_error(path + ": nenhuma posição");
+    }
+    return p;
+}
+
+inline Placement GeneratePlacement(const PlacementConfig& c) {
+    if (c.layout == "file") {
+        return ReadPlacementFile(c.file, c.count);
+    }
+
+    Placement p;
+    p.resize(c.count);
+    std::mt19937_64 rng(c.seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double twoPi = 2.0 * M_PI;
+
+    if (c.layout == "annulus" || c.layout == "disc") {
+        // Uniforme em área entre os raios r0 e r1
+        double r0 = c.layout == "disc" ? 0.0 : std::max(c.radius - c.width / 2, 0.0);
+        double r1 = c.layout == "disc" ? c.radius : c.radius + c.width / 2;
+        for (uint32_t i = 0; i < c.count; ++i) {
+            double r = std::sqrt(r0 * r0 + uniform(rng) * (r1 * r1 - r0 * r0));
+            double theta = twoPi * uniform(rng);
+            p.x[i] = r * std::cos(theta);
+            p.y[i] = r * std::sin(theta);
+        }
+    } else if (c.layout == "grid") {
+        uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(double(c.count))));
+        double offset = (columns - 1) * c.spacing / 2;
+        for (uint32_t i = 0; i < c.count; ++i) {
+            p.x[i] = (i % columns) * c.spacing - offset;
+            p.y[i] = (i / columns) * c.spacing - offset;
+        }
+    } else if (c.layout == "hex") {
+        // Coordenadas axiais; o anel k (6k pontos) parte de (-k, k) e
+        // percorre os 6 lados com k passos cada
+        static const int dq[6] = {1, 1, 0, -1, -1, 0};
+        static const int dr[6] = {0, -1, -1, 0, 1, 1};
+        uint32_t i = 0;
+        for (int k = 0; i < c.count; ++k) {
+            int q = -k;
+            int r = k;
+            for (int side = 0; side < 6 && i < c.count; ++side) {
+                for (int step = 0; step < std::max(k, 1) && i < c.count; ++step) {
+                    p.x[i] = c.spacing * (q + r / 2.0);
+                    p.y[i] = c.spacing * (r * std::sqrt(3.0) / 2.0);
+                    ++i;
+                    q += dq[side];
+                    r += dr[side];
+                }
+                if (k == 0) {
+                    break;
+                }
+            }
+        }
+    } else if (c.layout == "line") {
+        for (uint32_t i = 0; i < c.count; ++i) {
+            p.x[i] = c.radius;
+            p.y[i] = i * c.spacing;
+        }
+    } else {
+        throw std::invalid_argument("layout desconhecido: " + c.layout +
+                                    " (use annulus, disc, grid, hex, line ou file)");
+    }
+    return p;
+}
+
+// Uma posição fixa por nó, na ordem do container
+// Nós que já têm modelo de mobilidade (topologia reaproveitada entre
+// replicações) só mudam de posição
+inline void InstallPlacement(const ns3::NodeContainer& nodes, const Placement& p) {
+    if (p.size() < nodes.GetN()) {
+        throw std::invalid_argument("layout com menos posições que nós");
+    }
+    for (uint32_t i = 0; i < nodes.GetN(); ++i) {
+        ns3::Ptr<ns3::MobilityModel> m = nodes.Get(i)->GetObject<ns3::MobilityModel>();
+        if (!m) {
+            m = ns3::CreateObject<ns3::ConstantPositionMobilityModel>();
+            nodes.Get(i)->AggregateObject(m);
+        }
+        m->SetPosition(ns3::Vector(p.x[i], p.y[i], p.z[i]));
+    }
+}
+
+inline void InstallPosition(ns3::Ptr<ns3::Node> node, double x, double y, double z) {
+    ns3::Ptr<ns3::ConstantPositionMobilityModel> m = ns3::CreateObject<ns3::ConstantPositionMobilityModel>();
+    m->SetPosition(ns3::Vector(x, y, z));
+    node->AggregateObject(m);
+}
+
+} // namespace lpwan
+
+#endif // LPWAN_PLACEMENT_H
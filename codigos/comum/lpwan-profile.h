@@ -0,0 +1,210 @@
+/*
+ * Perfil de execução dos simuladores (--profile)
+ *
+ * Cronometra as fases de uma replicação com relógio monotônico:
+ *   - montagem:     nós, canal, mobilidade, pilha;
+ *   - instalação:   dispositivos, aplicações, traces e o que depende da
+ *                   execução antes do Run (posições, tráfego);
+ *   - execução:     Simulator::Run;
+ *   - encerramento: Simulator::Destroy.
+ * Também conta os eventos executados (Simulator::GetEventCount, lido a cada
+ * troca de fase, antes do Destroy), o tempo simulado (Simulator::Now no fim
+ * do Run), o pico de memória residente (getrusage) e as alocações por
+ * evento. Só entram as alocações feitas durante Simulator::Run: montagem,
+ * instalação e (no fork de --reuseTopology) a topologia do pai ficariam
+ * divididas pelos eventos e encobririam o custo por evento. As alocações vêm
+ * de operator new/delete
+ * substituídos neste header, que só contam com o perfil ligado: incluir só
+ * no .cc do simulador (cada binário é um arquivo só).
+ *
+ * Desligado, Begin()/End() retornam no primeiro teste e o contador de
+ * alocações fica num ramo nunca tomado.
+ */
+
+#ifndef LPWAN_PROFILE_H
+#define LPWAN_PROFILE_H
+
+#include "ns3/simulator.h"
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace lpwan {
+
+namespace detail {
+
+inline bool& CountAllocations() {
+    static bool on = false;
+    return on;
+}
+
+inline uint64_t& Allocations() {
+    static uint64_t count = 0;
+    return count;
+}
+
+} // namespace detail
+
+enum ProfilePhase : uint8_t {
+    PHASE_BUILD,
+    PHASE_INSTALL,
+    PHASE_RUN,
+    PHASE_TEARDOWN,
+    NUM_PHASES,
+    PHASE_NONE = NUM_PHASES
+};
+
+// Perfil de uma replicação (POD: volta dos workers junto com o resultado)
+struct RunProfile {
+    bool enabled;
+    double seconds[NUM_PHASES];
+    uint64_t events;
+    uint64_t allocations; // só na fase de execução
+    double peakRssMb;
+    double simulatedSeconds;
+
+    double EventsPerSecond() const { return seconds[PHASE_RUN] > 0.0 ? events / seconds[PHASE_RUN] : 0.0; }
+    double SimulatedPerSecond() const {
+        return seconds[PHASE_RUN] > 0.0 ? simulatedSeconds / seconds[PHASE_RUN] : 0.0;
+    }
+    double AllocationsPerEvent() const { return events > 0 ? double(allocations) / events : 0.0; }
+};
+
+static_assert(std::is_trivially_copyable<RunProfile>::value, "RunProfile precisa ser POD");
+
+class Profiler {
+public:
+    void Enable(bool on) {
+        m_profile = RunProfile{};
+        m_profile.enabled = on;
+        m_phase = PHASE_NONE;
+        detail::CountAllocations() = on;
+        detail::Allocations() = 0;
+    }
+
+    bool IsEnabled() const { return m_profile.enabled; }
+
+    // Fecha a fase atual (se houver) e abre `phase`; fases repetidas somam
+    void Begin(ProfilePhase phase) {
+        if (!m_profile.enabled) {
+            return;
+        }
+        End();
+        m_phase = phase;
+        m_start = Clock::now();
+        if (phase == PHASE_RUN) {
+            m_runAllocations = detail::Allocations();
+        }
+    }
+
+    void End() {
+        if (!m_profile.enabled || m_phase == PHASE_NONE) {
+            return;
+        }
+        m_profile.seconds[m_phase] += std::chrono::duration<double>(Clock::now() - m_start).count();
+        if (m_phase != PHASE_TEARDOWN) {
+            m_profile.events = ns3::Simulator::GetEventCount();
+        }
+        if (m_phase == PHASE_RUN) {
+            m_profile.simulatedSeconds = ns3::Simulator::Now().GetSeconds();
+            m_profile.allocations += detail::Allocations() - m_runAllocations;
+        }
+        m_phase = PHASE_NONE;
+    }
+
+    // Fecha a fase atual e devolve o perfil da replicação; o próximo começa
+    // do zero
+    RunProfile Finish() {
+        End();
+        RunProfile out = m_profile;
+        if (out.enabled) {
+            rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            out.peakRssMb = usage.ru_maxrss / 1024.0; // KB no Linux
+        }
+        Enable(m_profile.enabled);
+        return out;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    RunProfile m_profile{};
+    ProfilePhase m_phase = PHASE_NONE;
+    Clock::time_point m_start;
+    uint64_t m_runAllocations = 0; // contador no início da fase de execução
+};
+
+// Linhas acrescentadas ao bloco "=== RESULTADOS ... ==="
+inline void PrintRunProfile(std::ostream& os, const RunProfile& p) {
+    if (!p.enabled) {
+        return;
+    }
+    os << "Tempo Montagem (s): " << p.seconds[PHASE_BUILD] << std::endl;
+    os << "Tempo Instalação (s): " << p.seconds[PHASE_INSTALL] << std::endl;
+    os << "Tempo Execução (s): " << p.seconds[PHASE_RUN] << std::endl;
+    os << "Tempo Encerramento (s): " << p.seconds[PHASE_TEARDOWN] << std::endl;
+    os << "Eventos: " << p.events << std::endl;
+    os << "Eventos/s: " << p.EventsPerSecond() << std::endl;
+    os << "Tempo Simulado (s): " << p.simulatedSeconds << std::endl;
+    os << "Segundos Simulados/s: " << p.SimulatedPerSecond() << std::endl;
+    os << "Pico de Memória (MB): " << p.peakRssMb << std::endl;
+    os << "Alocações por Evento: " << p.AllocationsPerEvent() << std::endl;
+}
+
+// Colunas extras do CSV do ResultSink (começam com vírgula)
+inline std::string ProfileCsvHeader() {
+    return ",Tempo Montagem (s),Tempo Instalação (s),Tempo Execução (s),Tempo Encerramento (s),Eventos,Eventos/s,"
+           "Tempo Simulado (s),Segundos Simulados/s,Pico de Memória (MB),Alocações por Evento";
+}
+
+inline std::string ProfileCsvRow(const RunProfile& p) {
+    std::ostringstream ss;
+    ss << "," << p.seconds[PHASE_BUILD] << "," << p.seconds[PHASE_INSTALL] << "," << p.seconds[PHASE_RUN] << ","
+       << p.seconds[PHASE_TEARDOWN] << "," << p.events << "," << p.EventsPerSecond() << "," << p.simulatedSeconds << ","
+       << p.SimulatedPerSecond() << "," << p.peakRssMb << "," << p.AllocationsPerEvent();
+    return ss.str();
+}
+
+} // namespace lpwan
+
+// Contagem de alocações (operator new substituído para o binário inteiro)
+void* operator new(std::size_t size) {
+    if (lpwan::detail::CountAllocations()) {
+        lpwan::detail::Allocations()++;
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif // LPWAN_PROFILE_H
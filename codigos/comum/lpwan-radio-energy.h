@@ -0,0 +1,221 @@
+/*
+ * Energia do rádio por estado, integrada sob demanda
+ *
+ * Cada dispositivo guarda só as transições de estado do rádio (instante,
+ * estado, nível de potência de TX) num log compacto. A energia é integrada
+ * (corrente × tensão × tempo) quando pedida: Energy() / TotalEnergy() no fim
+ * da execução, sem nenhuma atualização por evento numa fonte de energia.
+ * Quando o log de um dispositivo passa de MAX_LOG entradas, as mais antigas
+ * são dobradas em totais de tempo por estado, então a memória fica limitada
+ * (~16 bytes por entrada + 12 totais por dispositivo) mesmo com 50k
+ * dispositivos e muitas mensagens.
+ *
+ * Transições podem ser registradas no futuro (ex.: janelas de recepção
+ * depois de um envio), desde que cada dispositivo as registre em ordem.
+ */
+
+#ifndef LPWAN_RADIO_ENERGY_H
+#define LPWAN_RADIO_ENERGY_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace lpwan {
+
+enum RadioState : uint8_t {
+    RADIO_SLEEP,
+    RADIO_IDLE, // standby / conectado sem tráfego
+    RADIO_RX,
+    RADIO_TX,
+    NUM_RADIO_STATES
+};
+
+static const uint32_t MAX_TX_LEVELS = 8;
+
+// Correntes (A) por estado e por nível de potência de TX, com a tensão (V)
+struct RadioProfile {
+    double voltage;
+    double sleepA;
+    double idleA;
+    double rxA;
+    uint32_t txLevels;
+    double txDbm[MAX_TX_LEVELS]; // crescente
+    double txA[MAX_TX_LEVELS];
+
+    // Menor nível cuja potência cobre txPowerDbm (o último se nenhum cobrir)
+    uint8_t TxLevel(double txPowerDbm) const {
+        for (uint32_t i = 0; i < txLevels; ++i) {
+            if (txDbm[i] >= txPowerDbm) {
+                return i;
+            }
+        }
+        return txLevels - 1;
+    }
+
+    double Current(uint8_t state, uint8_t level) const {
+        switch (state) {
+        case RADIO_SLEEP: return sleepA;
+        case RADIO_IDLE: return idleA;
+        case RADIO_RX: return rxA;
+        default: return txA[std::min<uint32_t>(level, txLevels - 1)];
+        }
+    }
+};
+
+// SX1276 (3,3 V): valores do LoraRadioEnergyModel do NS-3 para sleep,
+// standby e RX; TX pela curva do datasheet
+inline RadioProfile LoraRadioProfile() {
+    return RadioProfile{3.3, 1.5e-6, 0.0014, 0.0112, 4, {10, 14, 17, 20}, {0.022, 0.044, 0.087, 0.120}};
+}
+
+// Módulo NB-IoT classe 3 (3,6 V): PSM, conectado em DRX, RX e TX até 23 dBm
+inline RadioProfile NbIotRadioProfile() {
+    return RadioProfile{3.6, 3.5e-6, 0.006, 0.046, 3, {0, 10, 23}, {0.110, 0.140, 0.220}};
+}
+
+// Transceptor Sigfox RC1 (3,3 V), TX a 14 dBm
+inline RadioProfile SigfoxRadioProfile() {
+    return RadioProfile{3.3, 1.0e-6, 0.0015, 0.013, 1, {14}, {0.049}};
+}
+
+class RadioEnergyLog {
+public:
+    static const uint32_t MAX_LOG = 32;
+
+    void Reset(const RadioProfile& profile, uint32_t devices, double start = 0.0, uint8_t initial = RADIO_SLEEP) {
+        m_profile = profile;
+        m_logs.assign(devices, std::vector<Entry>(1, Entry{start, initial, 0}));
+        m_totals.assign(devices, Totals{});
+    }
+
+    uint32_t GetNDevices() const { return m_logs.size(); }
+    const RadioProfile& GetProfile() const { return m_profile; }
+
+    void SetState(uint32_t dev, double time, uint8_t state, uint8_t txLevel = 0) {
+        std::vector<Entry>& log = m_logs[dev];
+        time = std::max(time, log.back().time); // nunca volta no tempo
+        if (log.back().state == state && log.back().level == txLevel) {
+            return;
+        }
+        if (log.size() >= MAX_LOG) {
+            Fold(dev, log.size() - 1);
+        }
+        log.push_back(Entry{time, state, txLevel});
+    }
+
+    // Sequência comum: estado `state` de `start` a `start + duration`, e
+    // depois `after`
+    void Burst(uint32_t dev, double start, double duration, uint8_t state, uint8_t txLevel = 0,
+               uint8_t after = RADIO_SLEEP) {
+        SetState(dev, start, state, txLevel);
+        SetState(dev, start + duration, after);
+    }
+
+    // Envio LoRaWAN classe A: TX, RX1 um segundo após o fim do TX e RX2 dois
+    // segundos após (janelas de rx1Window e rx2Window segundos)
+    void LoraClassAUplink(uint32_t dev, double start, double toa, double rx1Window, double rx2Window,
+                          uint8_t txLevel) {
+        Burst(dev, start, toa, RADIO_TX, txLevel);
+        Burst(dev, start + toa + 1.0, rx1Window, RADIO_RX);
+        Burst(dev, start + toa + 2.0, rx2Window, RADIO_RX);
+    }
+
+    // Trecho [begin, end) em `offState` com `onTime` segundos em `onState` no
+    // início de cada período (ex.: ocasiões de paging em DRX/eDRX). As
+    // janelas não viram entradas no log: o tempo ligado vai direto para os
+    // totais. O chamador registra o estado seguinte em `end`.
+    void DutyCycle(uint32_t dev, double begin, double end, uint8_t onState, double onTime, double period,
+                   uint8_t offState = RADIO_SLEEP) {
+        SetState(dev, begin, offState);
+        if (end <= begin || period <= 0.0) {
+            return;
+        }
+        double cycles = std::floor((end - begin) / period);
+        double on = cycles * std::min(onTime, period) + std::min(onTime, end - begin - cycles * period);
+        Totals& t = m_totals[dev];
+        t.seconds[SlotOf(Entry{0.0, onState, 0})] += on;
+        t.seconds[SlotOf(Entry{0.0, offState, 0})] -= on;
+    }
+
+    // Segundos em `state` (soma de todos os níveis, para TX) até `until`
+    double StateTime(uint32_t dev, uint8_t state, double until) const {
+        Totals t = Integrate(dev, until);
+        if (state != RADIO_TX) {
+            return t.seconds[state];
+        }
+        double sum = 0.0;
+        for (uint32_t i = 0; i < MAX_TX_LEVELS; ++i) {
+            sum += t.seconds[RADIO_TX + i];
+        }
+        return sum;
+    }
+
+    // Energia (J) consumida pelo dispositivo até `until`
+    double Energy(uint32_t dev, double until) const {
+        Totals t = Integrate(dev, until);
+        double charge = 0.0; // C
+        for (uint32_t slot = 0; slot < NUM_SLOTS; ++slot) {
+            charge += t.seconds[slot] * CurrentOfSlot(slot);
+        }
+        return charge * m_profile.voltage;
+    }
+
+    double TotalEnergy(double until) const {
+        double sum = 0.0;
+        for (uint32_t dev = 0; dev < m_logs.size(); ++dev) {
+            sum += Energy(dev, until);
+        }
+        return sum;
+    }
+
+private:
+    struct Entry {
+        double time;
+        uint8_t state;
+        uint8_t level;
+    };
+
+    // Segundos por estado: SLEEP, IDLE, RX e um slot por nível de TX
+    static const uint32_t NUM_SLOTS = RADIO_TX + MAX_TX_LEVELS;
+    struct Totals {
+        std::array<double, NUM_SLOTS> seconds{};
+    };
+
+    static uint32_t SlotOf(const Entry& e) { return e.state == RADIO_TX ? RADIO_TX + e.level : e.state; }
+
+    double CurrentOfSlot(uint32_t slot) const {
+        return slot >= RADIO_TX ? m_profile.Current(RADIO_TX, slot - RADIO_TX) : m_profile.Current(slot, 0);
+    }
+
+    // Dobra as `count` entradas mais antigas nos totais (a última dobrada
+    // vira o início do log)
+    void Fold(uint32_t dev, size_t count) {
+        std::vector<Entry>& log = m_logs[dev];
+        for (size_t i = 0; i < count; ++i) {
+            m_totals[dev].seconds[SlotOf(log[i])] += log[i + 1].time - log[i].time;
+        }
+        log.erase(log.begin(), log.begin() + count);
+    }
+
+    Totals Integrate(uint32_t dev, double until) const {
+        Totals t = m_totals[dev];
+        const std::vector<Entry>& log = m_logs[dev];
+        for (size_t i = 0; i < log.size(); ++i) {
+            double begin = std::min(log[i].time, until);
+            double end = i + 1 < log.size() ? std::min(log[i + 1].time, until) : until;
+            t.seconds[SlotOf(log[i])] += std::max(end - begin, 0.0);
+        }
+        return t;
+    }
+
+    RadioProfile m_profile{};
+    std::vector<std::vector<Entry>> m_logs;
+    std::vector<Totals> m_totals;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_RADIO_ENERGY_H
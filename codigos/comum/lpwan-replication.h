@@ -0,0 +1,225 @@
+/*
+ * Replicações paralelas em processos isolados
+ *
+ * O Simulator do NS-3 é um singleton por processo, então replicações
+ * simultâneas precisam de processos separados. RunReplications faz fork() de
+ * até `jobs` workers ao mesmo tempo; cada worker executa uma replicação e
+ * devolve o registro (POD) ao processo pai por um pipe. O pai só chama fork()
+ * antes de usar o Simulator, portanto cada filho começa com estado limpo.
+ *
+ * ForkReplications sempre usa processos filhos, mesmo com jobs = 1: o pai
+ * pode montar a topologia antes (sem chamar Simulator::Run) e cada filho
+ * herda tudo por cópia sob escrita, executa a sua replicação e termina. O
+ * pai nunca roda o Simulator e continua com a topologia intacta para o
+ * próximo fork.
+ */
+
+#ifndef LPWAN_REPLICATION_H
+#define LPWAN_REPLICATION_H
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace lpwan {
+
+// Média e semiamplitude do intervalo de confiança (t de Student, 95%)
+struct MetricSummary {
+    double mean;
+    double halfWidth;
+    uint32_t n;
+};
+
+inline double StudentT95(uint32_t df) {
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df == 0) {
+        return 0.0;
+    }
+    return df <= 30 ? table[df - 1] : 1.96;
+}
+
+inline MetricSummary Summarize(const std::vector<double>& values) {
+    MetricSummary s{0.0, 0.0, static_cast<uint32_t>(values.size())};
+    if (values.empty()) {
+        return s;
+    }
+    for (double v : values) {
+        s.mean += v;
+    }
+    s.mean /= values.size();
+    if (values.size() > 1) {
+        double var = 0.0;
+        for (double v : values) {
+            var += (v - s.mean) * (v - s.mean);
+        }
+        var /= (values.size() - 1);
+        s.halfWidth = StudentT95(s.n - 1) * std::sqrt(var / s.n);
+    }
+    return s;
+}
+
+namespace detail {
+
+inline bool WriteAll(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Encerra e recolhe os workers ainda ativos (antes de propagar um erro)
+template <typename Worker>
+void KillWorkers(std::vector<Worker>& active) {
+    for (const Worker& w : active) {
+        kill(w.pid, SIGKILL);
+    }
+    for (const Worker& w : active) {
+        int status = 0;
+        while (waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        close(w.fd);
+    }
+    active.clear();
+}
+
+} // namespace detail
+
+// Executa fn(run) em processos filhos, um por execução de `runs`, com até
+// `jobs` (pelo menos 1) simultâneos. Os resultados voltam na ordem de `runs`.
+template <typename Result, typename Fn>
+std::vector<Result> ForkReplications(const std::vector<uint32_t>& runs, uint32_t jobs, Fn fn) {
+    static_assert(std::is_trivially_copyable<Result>::value, "Result precisa ser POD");
+
+    std::vector<Result> results(runs.size());
+    jobs = jobs > 0 ? jobs : 1;
+    struct Worker {
+        pid_t pid;
+        size_t index;
+        int fd;
+        size_t received;
+    };
+    std::vector<Worker> active;
+    size_t next = 0;
+
+    while (next < runs.size() || !active.empty()) {
+        while (next < runs.size() && active.size() < jobs) {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                detail::KillWorkers(active);
+                throw std::runtime_error("pipe() falhou");
+            }
+            pid_t pid = fork();
+            if (pid < 0) {
+                close(fds[0]);
+                close(fds[1]);
+                detail::KillWorkers(active);
+                throw std::runtime_error("fork() falhou");
+            }
+            if (pid == 0) {
+                // Uma exceção não pode subir pela pilha do pai dentro do filho
+                close(fds[0]);
+                bool ok = false;
+                try {
+                    Result r = fn(runs[next]);
+                    ok = detail::WriteAll(fds[1], &r, sizeof(r));
+                } catch (...) {
+                    _exit(1);
+                }
+                close(fds[1]);
+                _exit(ok ? 0 : 1);
+            }
+            close(fds[1]);
+            active.push_back(Worker{pid, next, fds[0], 0});
+            next++;
+        }
+
+        // Lê dos pipes à medida que os dados chegam; o registro pode ser
+        // maior que o buffer do pipe, então não dá para esperar o término antes
+        std::vector<pollfd> fds(active.size());
+        for (size_t i = 0; i < active.size(); ++i) {
+            fds[i].fd = active[i].fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            detail::KillWorkers(active);
+            throw std::runtime_error("poll() falhou");
+        }
+
+        for (size_t i = active.size(); i-- > 0;) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            Worker& w = active[i];
+            char* dst = reinterpret_cast<char*>(&results[w.index]);
+            ssize_t n = read(w.fd, dst + w.received, sizeof(Result) - w.received);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n > 0) {
+                w.received += n;
+                if (w.received < sizeof(Result)) {
+                    continue;
+                }
+            }
+
+            // Registro completo ou EOF: recolhe o processo
+            int status = 0;
+            while (waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {
+            }
+            close(w.fd);
+            bool ok = w.received == sizeof(Result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            active.erase(active.begin() + i);
+            if (!ok) {
+                detail::KillWorkers(active);
+                throw std::runtime_error("worker de replicação terminou com erro");
+            }
+        }
+    }
+    return results;
+}
+
+// Executa fn(run) para cada número de execução em `runs`, com até `jobs`
+// processos simultâneos. Com jobs <= 1 tudo roda no próprio processo, na
+// ordem dada. Os resultados voltam na mesma ordem de `runs`.
+template <typename Result, typename Fn>
+std::vector<Result> RunReplications(const std::vector<uint32_t>& runs, uint32_t jobs, Fn fn) {
+    static_assert(std::is_trivially_copyable<Result>::value, "Result precisa ser POD");
+
+    if (jobs > 1) {
+        return ForkReplications<Result>(runs, jobs, fn);
+    }
+    std::vector<Result> results(runs.size());
+    for (size_t i = 0; i < runs.size(); ++i) {
+        results[i] = fn(runs[i]);
+    }
+    return results;
+}
+
+} // namespace lpwan
+
+#endif // LPWAN_REPLICATION_H
@@ -0,0 +1,152 @@
+/*
+ * Destino de resultados compartilhado pelos simuladores
+ *
+ * Acumula as linhas em memória e, em Flush(), grava um "shard" por lote: um
+ * CSV e um .lpwr cujo nome identifica tecnologia, hash da configuração,
+ * semente e execuções (ex.: resultados_lorawan_3f2a..._s12345_r1.csv). Cada
+ * arquivo é escrito em <nome>.tmp.<pid> e renomeado no fim, então vários processos
+ * podem gravar no mesmo diretório sem truncar nem sobrescrever o trabalho um
+ * do outro e sem lock de arquivo; um shard visível está sempre completo.
+ */
+
+#ifndef LPWAN_RESULT_SINK_H
+#define LPWAN_RESULT_SINK_H
+
+#include "lpwan-results-bin.h"
+#include "lpwan-run-result.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lpwan {
+
+// Hash FNV-1a de 64 bits dos parâmetros do cenário ("nome=valor;" em ordem).
+// Só entram parâmetros que mudam o resultado (não a semente nem a execução).
+class ConfigHash {
+public:
+    template <typename T>
+    ConfigHash& Add(const std::string& name, const T& value) {
+        std::ostringstream ss;
+        ss << std::setprecision(17) << name << "=" << value << ";";
+        for (unsigned char c : ss.str()) {
+            m_hash ^= c;
+            m_hash *= 1099511628211ULL;
+        }
+        return *this;
+    }
+
+    uint64_t Get() const { return m_hash; }
+
+private:
+    uint64_t m_hash = 14695981039346656037ULL;
+};
+
+class ResultSink {
+public:
+    // prefix: "resultados_lorawan"; dir: diretório de saída (sem barra final)
+    ResultSink(const std::string& prefix, uint64_t technology, const std::string& simulator, uint64_t seed,
+               uint64_t configHash, double simulatedTime, const std::string& dir = ".")
+        : m_prefix(prefix),
+          m_technology(technology),
+          m_simulator(simulator),
+          m_seed(seed),
+          m_configHash(configHash),
+          m_simulatedTime(simulatedTime),
+          m_dir(dir) {}
+
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    void Add(const RunResult& r) { m_rows.push_back(r); }
+
+    // Linha com colunas extras só no CSV (ex.: ProfileCsvRow); `extraRow` e
+    // o cabeçalho de SetExtraColumns começam com vírgula
+    void Add(const RunResult& r, const std::string& extraRow) {
+        m_extraRows.resize(m_rows.size());
+        m_rows.push_back(r);
+        m_extraRows.push_back(extraRow);
+    }
+
+    void SetExtraColumns(const std::string& header) { m_extraHeader = header; }
+
+    // Grava as linhas pendentes num novo shard (CSV + .lpwr) e esvazia o buffer
+    void Flush() {
+        if (m_rows.empty()) {
+            return;
+        }
+        const std::string base = m_dir + "/" + ShardName();
+
+        std::ostringstream csv;
+        csv << "Semente,Hash Config,";
+        WriteCsvHeader(csv, m_extraHeader);
+        m_extraRows.resize(m_rows.size());
+        for (size_t i = 0; i < m_rows.size(); ++i) {
+            csv << m_seed << "," << HashHex() << ",";
+            WriteCsvRow(csv, m_rows[i], m_extraRows[i]);
+        }
+        WriteAtomic(base + ".csv", csv.str());
+
+        WriteResultsFile(base + ".lpwr", MakeResultsMetadata(m_simulator, m_seed, m_simulatedTime, m_configHash),
+                         m_technology, m_rows);
+        m_rows.clear();
+        m_extraRows.clear();
+    }
+
+    std::string HashHex() const {
+        std::ostringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << m_configHash;
+        return ss.str();
+    }
+
+private:
+    // <prefix>_<hash>_s<seed>_r<primeira>[-<última>]
+    std::string ShardName() const {
+        uint32_t first = m_rows.front().run;
+        uint32_t last = m_rows.front().run;
+        for (const RunResult& r : m_rows) {
+            first = std::min(first, r.run);
+            last = std::max(last, r.run);
+        }
+        std::ostringstream ss;
+        ss << m_prefix << "_" << HashHex() << "_s" << m_seed << "_r" << first;
+        if (last != first) {
+            ss << "-" << last;
+        }
+        return ss.str();
+    }
+
+    static void WriteAtomic(const std::string& path, const std::string& data) {
+        const std::string tmp = path + ".tmp." + std::to_string(getpid());
+        FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f) {
+            throw std::runtime_error("não foi possível criar " + tmp);
+        }
+        bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+        ok = (std::fclose(f) == 0) && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("falha ao gravar " + path);
+        }
+    }
+
+    std::string m_prefix;
+    uint64_t m_technology;
+    std::string m_simulator;
+    uint64_t m_seed;
+    uint64_t m_configHash;
+    double m_simulatedTime;
+    std::string m_dir;
+    std::vector<RunResult> m_rows;
+    std::string m_extraHeader;
+    std::vector<std::string> m_extraRows; // vazio = só as colunas padrão
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_RESULT_SINK_H
@@ -0,0 +1,291 @@
+/*
+ * Formato binário colunar de resultados (.lpwr)
+ *
+ * Substitui o parse por regex dos blocos "=== RESULTADOS ... ===". O arquivo
+ * tem um cabeçalho fixo com metadados da execução seguido de NUM_COLUMNS
+ * colunas contíguas de nRows valores de 8 bytes (inteiros como uint64,
+ * reais como double), na ordem de Column. O offset de cada coluna é
+ * calculável, então o leitor (ResultsFile) mapeia o arquivo com mmap e
+ * devolve ponteiros direto para os dados, sem cópia nem conversão de texto.
+ *
+ * Ordem de bytes: a da máquina que gravou (little-endian nas máquinas
+ * usadas); o campo byteOrder permite detectar arquivos incompatíveis.
+ */
+
+#ifndef LPWAN_RESULTS_BIN_H
+#define LPWAN_RESULTS_BIN_H
+
+#include "lpwan-run-result.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lpwan {
+
+// Códigos da coluna TECHNOLOGY
+enum Technology : uint64_t {
+    TECH_LORAWAN = 0,
+    TECH_NBIOT = 1,
+    TECH_SIGFOX = 2,
+    NUM_TECHNOLOGIES
+};
+
+// Mesmo nome usado no cabeçalho do bloco de texto ("=== RESULTADOS X ===")
+inline const char* TechnologyName(uint64_t tech) {
+    static const char* names[] = {"LORAWAN", "NB-IOT", "SIGFOX"};
+    return tech < NUM_TECHNOLOGIES ? names[tech] : "DESCONHECIDA";
+}
+
+// Esquema fixo: tecnologia, identificação do ponto, as 11 métricas e os
+// percentis do atraso
+enum Column {
+    COL_TECHNOLOGY,     // uint64 (Technology)
+    COL_RUN,            // uint64
+    COL_DISTANCE,       // double, m
+    COL_DEVICES,        // uint64
+    COL_PACKETS_SENT,   // uint64
+    COL_PACKETS_RECV,   // uint64
+    COL_PACKETS_DUP,    // uint64
+    COL_PDR,            // double, %
+    COL_PLR,            // double, %
+    COL_RETRANSMISSION, // double, %
+    COL_THROUGHPUT,     // double, bps
+    COL_CHANNEL_UTIL,   // double, %
+    COL_DELAY,          // double, s
+    COL_DELAY_P50,      // double, s
+    COL_DELAY_P90,      // double, s
+    COL_DELAY_P99,      // double, s
+    COL_DELAY_MAX,      // double, s
+    COL_BANDWIDTH,      // double, kHz
+    COL_ENERGY,         // double, J
+    NUM_COLUMNS
+};
+
+inline bool IsIntegerColumn(uint32_t c) {
+    return c == COL_TECHNOLOGY || c == COL_RUN || c == COL_DEVICES || c == COL_PACKETS_SENT ||
+           c == COL_PACKETS_RECV || c == COL_PACKETS_DUP;
+}
+
+// Metadados da execução gravados no cabeçalho
+struct ResultsMetadata {
+    char simulator[32];   // nome do programa que gerou o arquivo
+    uint64_t seed;        // RngSeedManager::GetSeed()
+    uint64_t createdAt;   // segundos desde a época (UTC)
+    double simulatedTime; // s de simulação por execução (0 se variável)
+    uint64_t configHash;  // hash dos parâmetros do cenário (0 se misto)
+};
+
+static const char RESULTS_MAGIC[8] = {'L', 'P', 'W', 'R', 'B', 'I', 'N', '\0'};
+static const uint32_t RESULTS_VERSION = 3;
+static const uint32_t RESULTS_BYTE_ORDER = 0x01020304;
+
+struct ResultsHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t headerSize;
+    uint32_t numColumns;
+    uint64_t numRows;
+    ResultsMetadata meta;
+};
+
+static_assert(sizeof(ResultsHeader) % 8 == 0, "colunas precisam ficar alinhadas em 8 bytes");
+
+inline ResultsMetadata MakeResultsMetadata(const std::string& simulator, uint64_t seed, double simulatedTime,
+                                           uint64_t configHash = 0) {
+    ResultsMetadata meta;
+    std::memset(&meta, 0, sizeof(meta));
+    std::strncpy(meta.simulator, simulator.c_str(), sizeof(meta.simulator) - 1);
+    meta.seed = seed;
+    meta.createdAt = static_cast<uint64_t>(std::time(nullptr));
+    meta.simulatedTime = simulatedTime;
+    meta.configHash = configHash;
+    return meta;
+}
+
+// Valor de uma linha na coluna c, como os 8 bytes gravados no arquivo
+inline uint64_t ColumnBits(uint64_t tech, const RunResult& r, uint32_t c) {
+    double d = 0.0;
+    switch (c) {
+    case COL_TECHNOLOGY: return tech;
+    case COL_RUN: return r.run;
+    case COL_DEVICES: return r.devices;
+    case COL_PACKETS_SENT: return r.packetsSent;
+    case COL_PACKETS_RECV: return r.packetsReceived;
+    case COL_PACKETS_DUP: return r.packetsDuplicated;
+    case COL_DISTANCE: d = r.distance; break;
+    case COL_PDR: d = r.pdr; break;
+    case COL_PLR: d = r.plr; break;
+    case COL_RETRANSMISSION: d = r.retransmissionRate; break;
+    case COL_THROUGHPUT: d = r.throughput; break;
+    case COL_CHANNEL_UTIL: d = r.channelUtilization; break;
+    case COL_DELAY: d = r.averageDelay; break;
+    case COL_DELAY_P50: d = r.delayP50; break;
+    case COL_DELAY_P90: d = r.delayP90; break;
+    case COL_DELAY_P99: d = r.delayP99; break;
+    case COL_DELAY_MAX: d = r.delayMax; break;
+    case COL_BANDWIDTH: d = r.bandwidthUsed; break;
+    case COL_ENERGY: d = r.energyConsumption; break;
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+// Grava `rows` em `path`; techs[i] é a tecnologia da linha i. A escrita vai
+// para um temporário (path + ".tmp.<pid>") e só é renomeada no fim, então um
+// arquivo .lpwr existente está sempre completo.
+inline void WriteResultsFile(const std::string& path, const ResultsMetadata& meta,
+                             const std::vector<uint64_t>& techs, const std::vector<RunResult>& rows) {
+    if (techs.size() != rows.size()) {
+        throw std::invalid_argument("techs e rows precisam ter o mesmo tamanho");
+    }
+    ResultsHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, RESULTS_MAGIC, sizeof(h.magic));
+    h.version = RESULTS_VERSION;
+    h.byteOrder = RESULTS_BYTE_ORDER;
+    h.headerSize = sizeof(ResultsHeader);
+    h.numColumns = NUM_COLUMNS;
+    h.numRows = rows.size();
+    h.meta = meta;
+
+    const std::string tmp = path + ".tmp." + std::to_string(getpid());
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        throw std::runtime_error("não foi possível criar " + tmp);
+    }
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+    std::vector<uint64_t> column(rows.size());
+    for (uint32_t c = 0; c < NUM_COLUMNS && ok; ++c) {
+        for (size_t i = 0; i < rows.size(); ++i) {
+            column[i] = ColumnBits(techs[i], rows[i], c);
+        }
+        ok = column.empty() || std::fwrite(column.data(), sizeof(uint64_t), column.size(), f) == column.size();
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("falha ao gravar " + path);
+    }
+}
+
+// Caso comum dos simuladores: todas as linhas da mesma tecnologia
+inline void WriteResultsFile(const std::string& path, const ResultsMetadata& meta, uint64_t tech,
+                             const std::vector<RunResult>& rows) {
+    WriteResultsFile(path, meta, std::vector<uint64_t>(rows.size(), tech), rows);
+}
+
+// Leitor somente leitura via mmap; as colunas apontam para o próprio mapeamento
+class ResultsFile {
+public:
+    ResultsFile() = default;
+    explicit ResultsFile(const std::string& path) { Open(path); }
+    ~ResultsFile() { Close(); }
+
+    ResultsFile(const ResultsFile&) = delete;
+    ResultsFile& operator=(const ResultsFile&) = delete;
+    ResultsFile(ResultsFile&& other) noexcept { *this = std::move(other); }
+    ResultsFile& operator=(ResultsFile&& other) noexcept {
+        if (this != &other) {
+            Close();
+            m_data = other.m_data;
+            m_size = other.m_size;
+            other.m_data = nullptr;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    void Open(const std::string& path) {
+        Close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("não foi possível abrir " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(ResultsHeader))) {
+            ::close(fd);
+            throw std::runtime_error(path + ": arquivo truncado");
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            throw std::runtime_error("mmap falhou em " + path);
+        }
+        m_data = static_cast<const char*>(p);
+        m_size = st.st_size;
+
+        const ResultsHeader& h = Header();
+        if (std::memcmp(h.magic, RESULTS_MAGIC, sizeof(h.magic)) != 0 || h.version != RESULTS_VERSION ||
+            h.byteOrder != RESULTS_BYTE_ORDER || h.numColumns != NUM_COLUMNS ||
+            h.headerSize != sizeof(ResultsHeader) ||
+            m_size != sizeof(ResultsHeader) + h.numRows * NUM_COLUMNS * sizeof(uint64_t)) {
+            Close();
+            throw std::runtime_error(path + ": não é um arquivo .lpwr compatível");
+        }
+    }
+
+    void Close() {
+        if (m_data) {
+            munmap(const_cast<char*>(m_data), m_size);
+            m_data = nullptr;
+            m_size = 0;
+        }
+    }
+
+    const ResultsHeader& Header() const { return *reinterpret_cast<const ResultsHeader*>(m_data); }
+    uint64_t GetNumRows() const { return Header().numRows; }
+
+    const uint64_t* IntColumn(uint32_t c) const { return reinterpret_cast<const uint64_t*>(ColumnData(c)); }
+    const double* RealColumn(uint32_t c) const { return reinterpret_cast<const double*>(ColumnData(c)); }
+
+    uint64_t GetTechnology(uint64_t row) const { return IntColumn(COL_TECHNOLOGY)[row]; }
+
+    // Reconstrói o registro de uma linha (conveniência; cópia de 18 valores)
+    RunResult GetRow(uint64_t row) const {
+        RunResult r;
+        r.run = static_cast<uint32_t>(IntColumn(COL_RUN)[row]);
+        r.devices = static_cast<uint32_t>(IntColumn(COL_DEVICES)[row]);
+        r.distance = RealColumn(COL_DISTANCE)[row];
+        r.packetsSent = IntColumn(COL_PACKETS_SENT)[row];
+        r.packetsReceived = IntColumn(COL_PACKETS_RECV)[row];
+        r.packetsDuplicated = IntColumn(COL_PACKETS_DUP)[row];
+        r.pdr = RealColumn(COL_PDR)[row];
+        r.plr = RealColumn(COL_PLR)[row];
+        r.retransmissionRate = RealColumn(COL_RETRANSMISSION)[row];
+        r.throughput = RealColumn(COL_THROUGHPUT)[row];
+        r.channelUtilization = RealColumn(COL_CHANNEL_UTIL)[row];
+        r.averageDelay = RealColumn(COL_DELAY)[row];
+        r.delayP50 = RealColumn(COL_DELAY_P50)[row];
+        r.delayP90 = RealColumn(COL_DELAY_P90)[row];
+        r.delayP99 = RealColumn(COL_DELAY_P99)[row];
+        r.delayMax = RealColumn(COL_DELAY_MAX)[row];
+        r.bandwidthUsed = RealColumn(COL_BANDWIDTH)[row];
+        r.energyConsumption = RealColumn(COL_ENERGY)[row];
+        return r;
+    }
+
+private:
+    const char* ColumnData(uint32_t c) const {
+        return m_data + sizeof(ResultsHeader) + uint64_t(c) * GetNumRows() * sizeof(uint64_t);
+    }
+
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_RESULTS_BIN_H
@@ -0,0 +1,81 @@
+/*
+ * Registro de resultados de uma execução LPWAN
+ *
+ * Estrutura POD com a identificação do ponto (execução, distância,
+ * dispositivos) e as 11 métricas do bloco padronizado "=== RESULTADOS ... ===",
+ * com os percentis do atraso por pacote (lpwan-latency-histogram.h).
+ * Por ser POD, pode ser copiada byte a byte entre processos (pipe) e gravada
+ * em formato binário.
+ */
+
+#ifndef LPWAN_RUN_RESULT_H
+#define LPWAN_RUN_RESULT_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+namespace lpwan {
+
+struct RunResult {
+    uint32_t run;
+    uint32_t devices;
+    double distance;
+    uint64_t packetsSent;
+    uint64_t packetsReceived;
+    uint64_t packetsDuplicated;
+    double pdr;                // %
+    double plr;                // %
+    double retransmissionRate; // %
+    double throughput;         // bps
+    double channelUtilization; // %
+    double averageDelay;       // s
+    double delayP50;           // s
+    double delayP90;           // s
+    double delayP99;           // s
+    double delayMax;           // s
+    double bandwidthUsed;      // kHz
+    double energyConsumption;  // J
+};
+
+static_assert(std::is_trivially_copyable<RunResult>::value, "RunResult precisa ser POD");
+
+// Bloco padronizado lido por scripts/converter_extendidos_csv.py
+inline void PrintRunResult(std::ostream& os, const std::string& technology, const RunResult& r) {
+    os << "=== RESULTADOS " << technology << " ===" << std::endl;
+    os << "Execução: " << r.run << std::endl;
+    os << "Distância (m): " << r.distance << std::endl;
+    os << "Dispositivos: " << r.devices << std::endl;
+    os << "Pacotes Enviados: " << r.packetsSent << std::endl;
+    os << "Pacotes Recebidos: " << r.packetsReceived << std::endl;
+    os << "Pacotes Duplicados: " << r.packetsDuplicated << std::endl;
+    os << "PDR (%): " << r.pdr << std::endl;
+    os << "PLR (%): " << r.plr << std::endl;
+    os << "Retransmissão (%): " << r.retransmissionRate << std::endl;
+    os << "Vazão (bps): " << r.throughput << std::endl;
+    os << "Utilização do Canal (%): " << r.channelUtilization << std::endl;
+    os << "Atraso Médio (s): " << r.averageDelay << std::endl;
+    os << "Atraso p50 (s): " << r.delayP50 << std::endl;
+    os << "Atraso p90 (s): " << r.delayP90 << std::endl;
+    os << "Atraso p99 (s): " << r.delayP99 << std::endl;
+    os << "Atraso Máximo (s): " << r.delayMax << std::endl;
+    os << "Banda Utilizada (kHz): " << r.bandwidthUsed << std::endl;
+    os << "Consumo Energia (J): " << r.energyConsumption << std::endl;
+}
+
+// `extra`: colunas adicionais já formatadas, começando com vírgula
+inline void WriteCsvHeader(std::ostream& os, const std::string& extra = "") {
+    os << "Execução,Distância (m),Dispositivos,Pacotes Enviados,Pacotes Recebidos,Pacotes Duplicados,PDR (%),PLR (%),Retransmissão (%),Vazão (bps),Utilização do Canal (%),Atraso Médio (s),Atraso p50 (s),Atraso p90 (s),Atraso p99 (s),Atraso Máximo (s),Banda Utilizada (kHz),Consumo Energia (J)" << extra << "\n";
+}
+
+inline void WriteCsvRow(std::ostream& os, const RunResult& r, const std::string& extra = "") {
+    os << r.run << "," << r.distance << "," << r.devices << "," << r.packetsSent << "," << r.packetsReceived << "," << r.packetsDuplicated << ","
+       << r.pdr << "," << r.plr << "," << r.retransmissionRate << "," << r.throughput << "," << r.channelUtilization << ","
+       << r.averageDelay << "," << r.delayP50 << "," << r.delayP90 << "," << r.delayP99 << "," << r.delayMax << ","
+       << r.bandwidthUsed << "," << r.energyConsumption << extra << "\n";
+}
+
+} // namespace lpwan
+
+#endif // LPWAN_RUN_RESULT_H
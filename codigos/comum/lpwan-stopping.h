@@ -0,0 +1,141 @@
+/*
+ * Número de replicações adaptativo (parada sequencial pelo IC)
+ *
+ * Em vez de um número fixo de execuções por ponto, as replicações continuam
+ * enquanto alguma das métricas escolhidas tiver semiamplitude relativa do
+ * IC 95% (halfWidth / |média|, ver Summarize em lpwan-replication.h) acima
+ * do alvo, sempre entre minRuns e maxRuns execuções. Pontos estáveis param
+ * cedo; pontos ruidosos (colisões, perdas raras) recebem mais execuções.
+ *
+ * O pedido de execuções adicionais usa a queda da semiamplitude com 1/sqrt(n):
+ * n necessário ≈ n × (relativa / alvo)², com o t de Student trocado pelo
+ * quantil normal para não superestimar com poucas execuções. Como a variância
+ * de poucas amostras é ruidosa, cada rodada no máximo dobra a amostra.
+ *
+ * Usado pelo lorawan-test (--ciTarget) e pela varredura (lpwan-sweep
+ * --ci-target); não depende do NS-3.
+ */
+
+#ifndef LPWAN_STOPPING_H
+#define LPWAN_STOPPING_H
+
+#include "lpwan-replication.h"
+#include "lpwan-run-result.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lpwan {
+
+// Métrica acompanhada pelo critério: nome curto (linha de comando), rótulo
+// no bloco "=== RESULTADOS ... ===" e campo do RunResult
+struct StoppingMetric {
+    const char* name;
+    const char* label;
+    double RunResult::*field;
+};
+
+inline const std::vector<StoppingMetric>& StoppingMetrics() {
+    static const std::vector<StoppingMetric> metrics = {
+        {"pdr", "PDR (%)", &RunResult::pdr},
+        {"delay", "Atraso Médio (s)", &RunResult::averageDelay},
+        {"energy", "Consumo Energia (J)", &RunResult::energyConsumption},
+        {"throughput", "Vazão (bps)", &RunResult::throughput},
+        {"p99", "Atraso p99 (s)", &RunResult::delayP99},
+    };
+    return metrics;
+}
+
+// "pdr,delay,energy" -> métricas; nome desconhecido é erro
+inline std::vector<StoppingMetric> ParseStoppingMetrics(const std::string& list) {
+    std::vector<StoppingMetric> chosen;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        bool found = false;
+        for (const StoppingMetric& m : StoppingMetrics()) {
+            if (item == m.name) {
+                chosen.push_back(m);
+                found = true;
+            }
+        }
+        if (!found) {
+            throw std::invalid_argument("Métrica desconhecida para o IC: " + item +
+                                        " (use pdr, delay, energy, throughput ou p99)");
+        }
+    }
+    if (chosen.empty()) {
+        throw std::invalid_argument("Nenhuma métrica para o critério de parada");
+    }
+    return chosen;
+}
+
+struct SequentialStopping {
+    double target = 0.0; // semiamplitude relativa (0.05 = ±5%); 0 = número fixo
+    uint32_t minRuns = 3;
+    uint32_t maxRuns = 30;
+
+    bool Enabled() const { return target > 0.0; }
+
+    // halfWidth / |média|; média nula só conta como estável sem variação
+    static double RelativeHalfWidth(const MetricSummary& s) {
+        if (s.n < 2) {
+            return std::numeric_limits<double>::infinity();
+        }
+        if (s.mean == 0.0) {
+            return s.halfWidth == 0.0 ? 0.0 : std::numeric_limits<double>::infinity();
+        }
+        return s.halfWidth / std::abs(s.mean);
+    }
+
+    // Pior semiamplitude relativa entre as métricas (uma amostra por métrica)
+    static double Worst(const std::vector<std::vector<double>>& samples) {
+        double worst = 0.0;
+        for (const std::vector<double>& values : samples) {
+            worst = std::max(worst, RelativeHalfWidth(Summarize(values)));
+        }
+        return worst;
+    }
+
+    bool Converged(const std::vector<std::vector<double>>& samples) const {
+        uint32_t n = samples.empty() ? 0 : samples.front().size();
+        return n >= minRuns && Worst(samples) <= target;
+    }
+
+    // Execuções a mais para a amostra atual (0 = parar: convergiu ou chegou
+    // a maxRuns); pelo menos `batch` quando continua, para ocupar os workers
+    uint32_t More(const std::vector<std::vector<double>>& samples, uint32_t batch = 1) const {
+        uint32_t n = samples.empty() ? 0 : samples.front().size();
+        if (n >= maxRuns) {
+            return 0;
+        }
+        if (n < std::max<uint32_t>(minRuns, 2)) {
+            return std::max<uint32_t>(minRuns, 2) - n;
+        }
+        double worst = Worst(samples);
+        if (worst <= target) {
+            return 0;
+        }
+        uint32_t extra = n; // sem estimativa (média nula): dobra
+        if (std::isfinite(worst)) {
+            double z = worst * 1.96 / StudentT95(n - 1);
+            double needed = std::ceil(n * (z / target) * (z / target));
+            extra = needed > n ? static_cast<uint32_t>(std::min<double>(needed - n, n)) : 1;
+        }
+        extra = std::max(extra, std::max<uint32_t>(batch, 1));
+        return std::min(extra, maxRuns - n);
+    }
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_STOPPING_H
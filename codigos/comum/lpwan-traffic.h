@@ -0,0 +1,154 @@
+/*
+ * Gerador de tráfego leve para os end devices
+ *
+ * Substitui o agendamento de um pacote por dispositivo antes de
+ * Simulator::Run(). Cada dispositivo tem no máximo um evento pendente: ao
+ * disparar, o gerador chama o callback de envio (que cria o pacote nesse
+ * instante) e agenda o próximo envio do mesmo dispositivo. Assim o custo
+ * inicial é O(N) eventos leves, sem nenhum pacote alocado, e a fila de
+ * eventos nunca passa de N entradas, qualquer que seja o número de mensagens.
+ *
+ * Padrões:
+ *   - single:   um envio por dispositivo em start + k * spacing (comportamento
+ *               original do lorawan-test);
+ *   - periodic: período fixo, fase inicial uniforme em [0, period);
+ *   - poisson:  intervalos exponenciais de média period;
+ *   - jittered: period * (1 + U(-jitter, jitter)), fase inicial uniforme.
+ * Os sorteios usam variáveis aleatórias do NS-3, então respeitam
+ * RngSeedManager::SetRun como o resto da simulação. AssignStreams (antes de
+ * Install) fixa os fluxos, para que a execução r dê o mesmo resultado com
+ * todas as execuções num processo ou uma por processo.
+ */
+
+#ifndef LPWAN_TRAFFIC_H
+#define LPWAN_TRAFFIC_H
+
+#include "ns3/core-module.h"
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lpwan {
+
+enum TrafficPattern {
+    TRAFFIC_SINGLE,
+    TRAFFIC_PERIODIC,
+    TRAFFIC_POISSON,
+    TRAFFIC_JITTERED
+};
+
+inline TrafficPattern ParseTrafficPattern(const std::string& name) {
+    if (name == "single") {
+        return TRAFFIC_SINGLE;
+    }
+    if (name == "periodic") {
+        return TRAFFIC_PERIODIC;
+    }
+    if (name == "poisson") {
+        return TRAFFIC_POISSON;
+    }
+    if (name == "jittered") {
+        return TRAFFIC_JITTERED;
+    }
+    throw std::invalid_argument("padrão de tráfego desconhecido: " + name +
+                                " (use single, periodic, poisson ou jittered)");
+}
+
+struct TrafficConfig {
+    TrafficPattern pattern = TRAFFIC_SINGLE;
+    double start = 1.0;      // s, primeiro envio possível
+    double spacing = 1.0;    // s, só em single: intervalo entre dispositivos
+    double period = 60.0;    // s, intervalo (médio) entre mensagens de um dispositivo
+    double jitter = 0.1;     // fração do período, só em jittered
+    double stop = 15.0;      // s, nenhum envio agendado depois deste instante
+    uint32_t maxPackets = 0; // por dispositivo; 0 = sem limite
+};
+
+// period <= 0 reagendaria o envio no mesmo instante para sempre (o Stop
+// nunca chega) e jitter >= 1 daria intervalos negativos
+inline void ValidateTrafficConfig(const TrafficConfig& config) {
+    if (!(config.period > 0.0)) {
+        throw std::invalid_argument("período de tráfego deve ser positivo: " + std::to_string(config.period));
+    }
+    if (!(config.jitter >= 0.0 && config.jitter < 1.0)) {
+        throw std::invalid_argument("jitter deve estar em [0, 1): " + std::to_string(config.jitter));
+    }
+}
+
+class TrafficGenerator {
+public:
+    using SendCallback = std::function<void(uint32_t dev)>;
+
+    TrafficGenerator()
+        : m_uniform(ns3::CreateObject<ns3::UniformRandomVariable>()),
+          m_exponential(ns3::CreateObject<ns3::ExponentialRandomVariable>()) {}
+
+    // Fluxos fixos a partir de `stream`; devolve quantos foram usados
+    int64_t AssignStreams(int64_t stream) {
+        m_uniform->SetStream(stream);
+        m_exponential->SetStream(stream + 1);
+        return 2;
+    }
+
+    // Agenda o primeiro envio de cada um dos `devices` dispositivos
+    void Install(uint32_t devices, const TrafficConfig& config, SendCallback send) {
+        ValidateTrafficConfig(config);
+        m_config = config;
+        m_send = send;
+        m_sent.assign(devices, 0);
+
+        for (uint32_t dev = 0; dev < devices; ++dev) {
+            double first = config.start;
+            switch (config.pattern) {
+            case TRAFFIC_SINGLE: first += dev * config.spacing; break;
+            case TRAFFIC_POISSON: first += m_exponential->GetValue(config.period, 0.0); break;
+            case TRAFFIC_PERIODIC:
+            case TRAFFIC_JITTERED: first += m_uniform->GetValue(0.0, config.period); break;
+            }
+            ScheduleAt(dev, first);
+        }
+    }
+
+    uint32_t GetSent(uint32_t dev) const { return m_sent[dev]; }
+
+private:
+    void ScheduleAt(uint32_t dev, double when) {
+        if (when > m_config.stop) {
+            return;
+        }
+        double now = ns3::Simulator::Now().GetSeconds();
+        ns3::Simulator::Schedule(ns3::Seconds(when - now), &TrafficGenerator::Fire, this, dev);
+    }
+
+    void Fire(uint32_t dev) {
+        m_send(dev);
+        m_sent[dev]++;
+        if (m_config.pattern == TRAFFIC_SINGLE ||
+            (m_config.maxPackets > 0 && m_sent[dev] >= m_config.maxPackets)) {
+            return;
+        }
+        ScheduleAt(dev, ns3::Simulator::Now().GetSeconds() + NextInterval());
+    }
+
+    double NextInterval() {
+        switch (m_config.pattern) {
+        case TRAFFIC_POISSON: return m_exponential->GetValue(m_config.period, 0.0);
+        case TRAFFIC_JITTERED:
+            return m_config.period * (1.0 + m_uniform->GetValue(-m_config.jitter, m_config.jitter));
+        default: return m_config.period;
+        }
+    }
+
+    TrafficConfig m_config;
+    SendCallback m_send;
+    std::vector<uint32_t> m_sent;
+    ns3::Ptr<ns3::UniformRandomVariable> m_uniform;
+    ns3::Ptr<ns3::ExponentialRandomVariable> m_exponential;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_TRAFFIC_H
@@ -0,0 +1,157 @@
+/*
+ * Deduplicação e pacotes em voo por UID, com memória limitada
+ *
+ * Os UIDs de pacote do NS-3 são crescentes, então a deduplicação usa um
+ * bitmap circular sobre o deslocamento do UID (janela dos últimos W UIDs) e
+ * os dados de envio ficam num anel de capacidade fixa indexado por
+ * (UID & máscara). Nenhuma operação aloca depois de Reset(); envio e
+ * recepção são O(1) e a memória não cresce com a duração da execução.
+ *
+ * Pacotes perdidos expiram sozinhos: a entrada é sobrescrita quando o anel dá
+ * a volta, e recepções mais velhas que maxAge são tratadas como perda. Os
+ * dois casos contam em GetExpired(), que os simuladores imprimem no bloco de
+ * resultados ("Pacotes Expirados"), para um anel pequeno demais ou um maxAge
+ * curto demais não virar perda sem aviso. Os simuladores passam a duração da
+ * simulação como maxAge, então nenhum atraso possível dentro da execução
+ * (fila RLC do LTE inclusive) é descartado.
+ */
+
+#ifndef LPWAN_UID_TRACKER_H
+#define LPWAN_UID_TRACKER_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace lpwan {
+
+class UidTracker {
+public:
+    static constexpr uint32_t NO_DEVICE = std::numeric_limits<uint32_t>::max();
+
+    enum Status {
+        FIRST,     // primeira cópia de um pacote em voo
+        DUPLICATE, // UID já recebido antes
+        UNKNOWN    // não enviado por um dispositivo, expirado ou fora da janela
+    };
+
+    struct Reception {
+        Status status;
+        uint32_t dev;    // dispositivo de origem (NO_DEVICE se desconhecido)
+        double sendTime; // s
+    };
+
+    // Dimensionamento comum a todos os simuladores: até IN_FLIGHT_PER_DEVICE
+    // pacotes em voo por dispositivo
+    static constexpr uint32_t IN_FLIGHT_PER_DEVICE = 10;
+
+    // maxAge: idade (s) a partir da qual um pacote é considerado perdido
+    void Reset(uint64_t devices, double maxAge) { ResetCapacity(devices * IN_FLIGHT_PER_DEVICE, maxAge); }
+
+    // maxInFlight: pacotes simultaneamente em voo esperados (define o anel)
+    void ResetCapacity(uint64_t maxInFlight, double maxAge) {
+        uint64_t capacity = 1024;
+        while (capacity < 2 * maxInFlight) {
+            capacity <<= 1;
+        }
+        m_mask = capacity - 1;
+        m_ring.assign(capacity, Entry{NO_UID, 0.0, NO_DEVICE, false, false});
+
+        // Janela de deduplicação 4x maior que o anel (1 bit por UID)
+        m_windowBits = capacity * 4;
+        m_bitmap.assign(m_windowBits / 64, 0);
+        m_maxUid = 0;
+        m_started = false;
+        m_maxAge = maxAge;
+        m_expired = 0;
+    }
+
+    void RecordSend(uint64_t uid, uint32_t dev, double now) {
+        AdvanceWindow(uid);
+        Entry& e = m_ring[uid & m_mask];
+        if (e.uid != NO_UID && !e.received && !e.late) {
+            m_expired++; // sobrescrito sem ter sido recebido: perdido
+        }
+        e = Entry{uid, now, dev, false, false};
+    }
+
+    Reception RecordReceive(uint64_t uid, double now) {
+        if (!m_started || uid > m_maxUid || m_maxUid - uid >= m_windowBits) {
+            return Reception{UNKNOWN, NO_DEVICE, 0.0};
+        }
+
+        Entry& e = m_ring[uid & m_mask];
+        bool inRing = (e.uid == uid);
+        uint64_t& word = m_bitmap[(uid % m_windowBits) / 64];
+        uint64_t bit = uint64_t(1) << (uid % 64);
+        if (word & bit) {
+            return Reception{DUPLICATE, inRing ? e.dev : NO_DEVICE, inRing ? e.sendTime : 0.0};
+        }
+        if (!inRing) {
+            return Reception{UNKNOWN, NO_DEVICE, 0.0};
+        }
+        if (now - e.sendTime > m_maxAge) {
+            if (!e.late) {
+                e.late = true;
+                m_expired++; // chegou depois de maxAge: perdido (uma vez por pacote)
+            }
+            return Reception{UNKNOWN, NO_DEVICE, 0.0};
+        }
+        word |= bit;
+        e.received = true;
+        return Reception{FIRST, e.dev, e.sendTime};
+    }
+
+    // Pacotes descartados do anel sem nunca terem sido recebidos ou
+    // recebidos depois de maxAge
+    uint64_t GetExpired() const { return m_expired; }
+
+private:
+    static constexpr uint64_t NO_UID = std::numeric_limits<uint64_t>::max();
+
+    struct Entry {
+        uint64_t uid;
+        double sendTime;
+        uint32_t dev;
+        bool received;
+        bool late; // recepção descartada por idade (já contada em m_expired)
+    };
+
+    // Move a janela até `uid`, limpando os bits dos UIDs que entram nela
+    void AdvanceWindow(uint64_t uid) {
+        if (!m_started) {
+            m_started = true;
+            m_maxUid = uid;
+            ClearBit(uid);
+            return;
+        }
+        if (uid <= m_maxUid) {
+            return;
+        }
+        if (uid - m_maxUid >= m_windowBits) {
+            m_bitmap.assign(m_bitmap.size(), 0);
+        } else {
+            for (uint64_t u = m_maxUid + 1; u <= uid; ++u) {
+                ClearBit(u);
+            }
+        }
+        m_maxUid = uid;
+    }
+
+    void ClearBit(uint64_t uid) {
+        m_bitmap[(uid % m_windowBits) / 64] &= ~(uint64_t(1) << (uid % 64));
+    }
+
+    std::vector<Entry> m_ring;
+    std::vector<uint64_t> m_bitmap;
+    uint64_t m_mask = 0;
+    uint64_t m_windowBits = 0;
+    uint64_t m_maxUid = 0;
+    bool m_started = false;
+    double m_maxAge = 0.0;
+    uint64_t m_expired = 0;
+};
+
+} // namespace lpwan
+
+#endif // LPWAN_UID_TRACKER_H
@@ -0,0 +1,215 @@
+/*
+ * Canal LPWAN com recorte espacial para as versões simplificadas
+ *
+ * Substitui o YansWifiChannel, que entrega cada transmissão a todos os nós
+ * do canal (custo O(N²) com o número de dispositivos). Em LPWAN os
+ * dispositivos nunca precisam ouvir uns aos outros, então:
+ *   - uplink (dispositivo -> rede): só os gateways a até maxRange metros
+ *     recebem, consultados numa grade espacial (hash de células);
+ *   - downlink unicast (gateway -> dispositivo): só o destinatário;
+ *   - downlink broadcast: só os dispositivos nas células a até maxRange.
+ * maxRange sai da sensibilidade do receptor: é a maior distância em que o
+ * modelo de perda ainda entrega potência >= sensibilidade. Cada candidato
+ * ainda passa pelo modelo de perda antes da entrega, ou, com SetLinkBudget(),
+ * pela LinkBudgetTable pré-calculada (linha = ordem dos dispositivos no
+ * canal, coluna = ordem dos gateways), sem consultar o modelo por evento.
+ *
+ * Uso: instalar SimpleNetDevice nos nós com este canal, marcar os gateways
+ * com AddGateway() e configurar SetPropagation() antes de Simulator::Run().
+ * As posições são lidas uma única vez, na primeira transmissão (nós fixos).
+ * PopulateStarArp() evita o ARP por broadcast, que no gateway voltaria a
+ * custar O(N) por dispositivo.
+ */
+
+#ifndef LPWAN_UPLINK_CHANNEL_H
+#define LPWAN_UPLINK_CHANNEL_H
+
+#include "lpwan-link-budget.h"
+#include "lpwan-spatial-grid.h"
+
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/propagation-module.h"
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace lpwan {
+
+class UplinkChannel : public ns3::SimpleChannel {
+public:
+    static ns3::TypeId GetTypeId() {
+        static ns3::TypeId tid = ns3::TypeId("lpwan::UplinkChannel")
+                                     .SetParent<ns3::SimpleChannel>()
+                                     .SetGroupName("Network")
+                                     .AddConstructor<UplinkChannel>();
+        return tid;
+    }
+
+    // Potência de transmissão, sensibilidade do receptor e modelo de perda.
+    // maxRange é obtido por bisseção sobre o próprio modelo de perda.
+    void SetPropagation(ns3::Ptr<ns3::PropagationLossModel> loss, double txPowerDbm, double sensitivityDbm) {
+        m_loss = loss;
+        m_txPowerDbm = txPowerDbm;
+        m_sensitivityDbm = sensitivityDbm;
+        m_maxRange = ComputeMaxRange(m_loss, m_txPowerDbm, m_sensitivityDbm);
+        m_indexed = false;
+    }
+
+    double GetMaxRange() const { return m_maxRange; }
+
+    // Uplinks passam a usar a potência da tabela (que precisa seguir a mesma
+    // ordem de Add() dos dispositivos e dos gateways)
+    void SetLinkBudget(const LinkBudgetTable* table) { m_table = table; }
+
+    void Add(ns3::Ptr<ns3::SimpleNetDevice> device) override {
+        ns3::SimpleChannel::Add(device);
+        m_nodes.push_back(device);
+        m_indexed = false;
+    }
+
+    void AddGateway(ns3::Ptr<ns3::NetDevice> device) {
+        m_gatewaySet.insert(ns3::PeekPointer(device));
+        m_indexed = false;
+    }
+
+    void Send(ns3::Ptr<ns3::Packet> p, uint16_t protocol, ns3::Mac48Address to, ns3::Mac48Address from,
+              ns3::Ptr<ns3::SimpleNetDevice> sender) override {
+        if (!m_indexed) {
+            BuildIndex();
+        }
+        auto self = m_index.find(from);
+        if (self == m_index.end()) {
+            return;
+        }
+        const Entry& src = m_entries[self->second];
+
+        if (!src.gateway) {
+            // Uplink: só gateways próximos; outros dispositivos nunca ouvem
+            m_gatewayGrid.ForEachNear(src.x, src.y,
+                                      [&](uint32_t id) { Deliver(src, m_entries[id], p, protocol, to, from); });
+        } else if (to.IsBroadcast() || to.IsGroup()) {
+            m_deviceGrid.ForEachNear(src.x, src.y,
+                                     [&](uint32_t id) { Deliver(src, m_entries[id], p, protocol, to, from); });
+        } else {
+            auto dst = m_index.find(to);
+            if (dst != m_index.end()) {
+                Deliver(src, m_entries[dst->second], p, protocol, to, from);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        ns3::Ptr<ns3::SimpleNetDevice> device;
+        ns3::Ptr<ns3::MobilityModel> mobility;
+        double x;
+        double y;
+        double z;
+        bool gateway;
+        uint32_t slot; // linha (dispositivo) ou coluna (gateway) na tabela
+    };
+
+    void BuildIndex() {
+        uint32_t devices = 0;
+        uint32_t gateways = 0;
+        m_entries.clear();
+        m_index.clear();
+        m_gatewayGrid.Reset(m_maxRange);
+        m_deviceGrid.Reset(m_maxRange);
+        for (const ns3::Ptr<ns3::SimpleNetDevice>& dev : m_nodes) {
+            Entry e;
+            e.device = dev;
+            e.mobility = dev->GetNode()->GetObject<ns3::MobilityModel>();
+            ns3::Vector pos = e.mobility->GetPosition();
+            e.x = pos.x;
+            e.y = pos.y;
+            e.z = pos.z;
+            e.gateway = m_gatewaySet.count(ns3::PeekPointer(dev)) > 0;
+            e.slot = e.gateway ? gateways++ : devices++;
+            uint32_t id = static_cast<uint32_t>(m_entries.size());
+            (e.gateway ? m_gatewayGrid : m_deviceGrid).Insert(id, e.x, e.y);
+            m_index[ns3::Mac48Address::ConvertFrom(dev->GetAddress())] = id;
+            m_entries.push_back(e);
+        }
+        m_indexed = true;
+    }
+
+    void Deliver(const Entry& src, const Entry& dst, ns3::Ptr<ns3::Packet> p, uint16_t protocol,
+                 ns3::Mac48Address to, ns3::Mac48Address from) {
+        if (dst.device == src.device) {
+            return;
+        }
+        double dx = src.x - dst.x;
+        double dy = src.y - dst.y;
+        double dz = src.z - dst.z;
+        double d = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (d > m_maxRange) {
+            return;
+        }
+        double rx = (m_table && !src.gateway && dst.gateway)
+                        ? m_table->RxPower(src.slot, dst.slot, m_txPowerDbm)
+                        : m_loss->CalcRxPower(m_txPowerDbm, src.mobility, dst.mobility);
+        if (rx < m_sensitivityDbm) {
+            return;
+        }
+        ns3::Time delay = ns3::Seconds(d / 299792458.0);
+        ns3::Simulator::ScheduleWithContext(dst.device->GetNode()->GetId(), delay, &ns3::SimpleNetDevice::Receive,
+                                            dst.device, p->Copy(), protocol, to, from);
+    }
+
+    ns3::Ptr<ns3::PropagationLossModel> m_loss;
+    double m_txPowerDbm = 14.0;
+    double m_sensitivityDbm = -137.0;
+    double m_maxRange = 1.0;
+    const LinkBudgetTable* m_table = nullptr;
+
+    std::vector<ns3::Ptr<ns3::SimpleNetDevice>> m_nodes;
+    std::set<const ns3::NetDevice*> m_gatewaySet;
+    bool m_indexed = false;
+    std::vector<Entry> m_entries;
+    std::map<ns3::Mac48Address, uint32_t> m_index;
+    SpatialGrid m_gatewayGrid;
+    SpatialGrid m_deviceGrid;
+};
+
+// Entradas ARP permanentes em topologia estrela: cada dispositivo conhece
+// os gateways e cada gateway conhece os dispositivos (O(N·G), sem os N²
+// pares que NeighborCacheHelper criaria num canal compartilhado)
+inline void PopulateStarArp(const ns3::NetDeviceContainer& gateways, const ns3::NetDeviceContainer& devices) {
+    struct Side {
+        ns3::Ptr<ns3::ArpCache> cache;
+        ns3::Ipv4Address ip;
+        ns3::Address mac;
+    };
+    auto describe = [](ns3::Ptr<ns3::NetDevice> dev) {
+        ns3::Ptr<ns3::Ipv4L3Protocol> ipv4 = dev->GetNode()->GetObject<ns3::Ipv4L3Protocol>();
+        ns3::Ptr<ns3::Ipv4Interface> iface = ipv4->GetInterface(ipv4->GetInterfaceForDevice(dev));
+        return Side{iface->GetArpCache(), iface->GetAddress(0).GetLocal(), dev->GetAddress()};
+    };
+    auto learn = [](const Side& owner, const Side& peer) {
+        ns3::ArpCache::Entry* entry = owner.cache->Add(peer.ip);
+        entry->SetMacAddress(peer.mac);
+        entry->MarkPermanent();
+    };
+
+    std::vector<Side> gw;
+    for (uint32_t g = 0; g < gateways.GetN(); ++g) {
+        gw.push_back(describe(gateways.Get(g)));
+    }
+    for (uint32_t i = 0; i < devices.GetN(); ++i) {
+        Side dev = describe(devices.Get(i));
+        for (const Side& g : gw) {
+            learn(dev, g);
+            learn(g, dev);
+        }
+    }
+}
+
+} // namespace lpwan
+
+#endif // LPWAN_UPLINK_CHANNEL_H
@@ -0,0 +1,493 @@
+/*
+ * Benchmark de escala dos simuladores LPWAN
+ *
+ * Roda os seis binários (lorawan-test, nb-iot-sim, sigfox_simulacao_explicada
+ * e os três *_simplificado) numa escada de quantidades de dispositivos
+ * (10 -> 50000), com semente e execução fixas e --profile=1, um de cada vez
+ * (medidas de tempo não dividem a máquina). De cada ponto guarda a mediana
+ * de --repeat repetições de:
+ *   - tempo de parede do simulador (soma das fases do perfil, sem o
+ *     wrapper ./ns3);
+ *   - segundos simulados por segundo de execução;
+ *   - pico de memória residente;
+ *   - eventos processados (determinísticos com semente fixa).
+ * Para cada binário ajusta o expoente de escala empírico (mínimos quadrados
+ * de log(tempo) e log(memória) contra log(dispositivos)).
+ *
+ * Com --baseline=ARQ compara com um CSV gravado antes por --save-baseline e
+ * sai com código 3 se algum ponto ficou mais lento ou maior que a tolerância
+ * ou se algum expoente cresceu. Não há linha de base versionada: ela depende
+ * da máquina e é gerada nela.
+ *
+ * Um ponto que passa de --timeout segundos é interrompido e encerra a escada
+ * daquele binário (os maiores também passariam).
+ *
+ * Cada série pode ter um teto na escada (--cap-<série>=N, 0 = sem teto);
+ * pontos acima dele não são executados. O nb-iot-sim com a pilha LTE/EPC
+ * completa fica em 320 UEs, a capacidade da célula (configurações de SRS do
+ * LteEnbRrc; acima disso o simulador recusa a execução). A série
+ * nb-iot-sim-reduced roda o mesmo binário com --model=reduced na escada
+ * inteira, então o NB-IoT também é medido até 50000 UEs sem misturar os dois
+ * modelos num mesmo expoente.
+ *
+ * Compilação (não depende do NS-3):
+ *   g++ -O2 -std=c++17 codigos/ferramentas/lpwan-bench.cc -o lpwan-bench
+ *
+ * Exemplo:
+ *   ./lpwan-bench --ns3=$HOME/ns3_test/ns-3-dev --save-baseline=linha_base.csv
+ *   ./lpwan-bench --ns3=$HOME/ns3_test/ns-3-dev --baseline=linha_base.csv
+ */
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Um ponto da escada (mediana das repetições)
+struct Ponto {
+    std::string binario;
+    uint32_t dispositivos = 0;
+    uint32_t repeticoes = 0;
+    double parede = 0.0;      // s, soma das fases do perfil
+    double execucao = 0.0;    // s, só Simulator::Run
+    double simuladosPorSegundo = 0.0;
+    uint64_t eventos = 0;
+    double eventosPorSegundo = 0.0;
+    double memoria = 0.0;     // MB, pico de RSS
+    std::string status = "ok";
+};
+
+struct Config {
+    std::string ns3Dir;
+    std::string outDir = "resultados_benchmark";
+    std::string baseline;
+    std::string saveBaseline;
+    uint32_t repeat = 3;
+    uint32_t seed = 12345;
+    uint32_t distancia = 3000;
+    double timeout = 1800.0;
+    double tolerancia = 0.25;         // fração acima da linha de base
+    double toleranciaExpoente = 0.15; // absoluta
+    double minimoParede = 0.05;       // s, pontos mais rápidos não entram na comparação de tempo
+    std::vector<std::string> binarios = {"lorawan-test",         "nb-iot-sim",         "nb-iot-sim-reduced",
+                                         "sigfox_simulacao_explicada", "lorawan_simplificado", "nbiot_simplificado",
+                                         "sigfox_simplificado"};
+    std::vector<uint32_t> dispositivos = {10, 100, 1000, 5000, 10000, 30000, 50000};
+    std::map<std::string, std::string> comandos;
+    std::map<std::string, uint32_t> tetos = {{"nb-iot-sim", 320}}; // maior ponto da escada por série
+};
+
+// Linhas de comando padrão por binário. Marcadores substituídos em
+// ExpandirComando: {ns3} {cwd} {dist} {dev} {seed}
+static std::map<std::string, std::string> ComandosPadrao() {
+    const std::string run = "{ns3}/ns3 run --no-build --cwd={cwd} \"";
+    const std::string comum = " --RngSeed={seed} --RngRun=1 --profile=1\"";
+    return {
+        {"lorawan-test", run + "lorawan-test --distance={dist} --deviceCount={dev} --runSeed={seed} --firstRun=1 "
+                               "--numExecutions=1 --profile=1\""},
+        {"nb-iot-sim", run + "nb-iot-sim --distance={dist} --nUe={dev}" + comum},
+        {"nb-iot-sim-reduced", run + "nb-iot-sim --model=reduced --distance={dist} --nUe={dev}" + comum},
+        {"sigfox_simulacao_explicada", run + "sigfox_simulacao_explicada --distance={dist} --nDevices={dev}" + comum},
+        {"lorawan_simplificado", run + "lorawan_simplificado --distance={dist} --nDevices={dev}" + comum},
+        {"nbiot_simplificado", run + "nbiot_simplificado --distance={dist} --nDevices={dev}" + comum},
+        {"sigfox_simplificado", run + "sigfox_simplificado --distance={dist} --nDevices={dev}" + comum},
+    };
+}
+
+static void Substituir(std::string& texto, const std::string& chave, const std::string& valor) {
+    for (size_t pos = texto.find(chave); pos != std::string::npos; pos = texto.find(chave, pos + valor.size())) {
+        texto.replace(pos, chave.size(), valor);
+    }
+}
+
+static std::string ExpandirComando(const Config& cfg, const std::string& binario, uint32_t dev,
+                                   const std::string& cwd) {
+    std::string cmd = cfg.comandos.at(binario);
+    Substituir(cmd, "{ns3}", cfg.ns3Dir);
+    Substituir(cmd, "{cwd}", cwd);
+    Substituir(cmd, "{dist}", std::to_string(cfg.distancia));
+    Substituir(cmd, "{dev}", std::to_string(dev));
+    Substituir(cmd, "{seed}", std::to_string(cfg.seed));
+    return cmd;
+}
+
+// Valor da linha "<chave>: <valor>" do bloco de perfil (-1 se ausente)
+static double LerCampo(const std::string& saida, const std::string& chave) {
+    size_t pos = saida.find("\n" + chave + ": ");
+    if (pos == std::string::npos) {
+        return -1.0;
+    }
+    return std::atof(saida.c_str() + pos + chave.size() + 3);
+}
+
+// Executa uma repetição num diretório próprio; o grupo de processos inteiro
+// (sh, ./ns3 e o simulador) é morto no timeout
+static std::string ExecutarUma(const Config& cfg, const std::string& binario, uint32_t dev, Ponto& medida) {
+    std::ostringstream nome;
+    nome << binario << "_" << dev << "dev";
+    const fs::path cwd = fs::absolute(fs::path(cfg.outDir) / "tmp" / nome.str());
+    const fs::path saida = fs::path(cfg.outDir) / (nome.str() + ".txt");
+    const fs::path log = fs::path(cfg.outDir) / "logs" / (nome.str() + ".log");
+    fs::create_directories(cwd);
+    const std::string cmd = ExpandirComando(cfg, binario, dev, cwd.string());
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        int out = open(saida.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        int err = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0 || err < 0 || chdir(cwd.c_str()) != 0) {
+            _exit(127);
+        }
+        dup2(out, STDOUT_FILENO);
+        dup2(err, STDERR_FILENO);
+        execl("/bin/sh", "sh", "-c", cmd.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    if (pid < 0) {
+        return "falha";
+    }
+    setpgid(pid, pid);
+
+    const auto inicio = std::chrono::steady_clock::now();
+    int status = 0;
+    bool estourou = false;
+    for (;;) {
+        pid_t r = waitpid(pid, &status, WNOHANG);
+        if (r == pid || (r < 0 && errno != EINTR)) {
+            break;
+        }
+        double decorrido = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        if (cfg.timeout > 0.0 && decorrido > cfg.timeout && !estourou) {
+            kill(-pid, SIGKILL);
+            estourou = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    std::error_code ec;
+    fs::remove_all(cwd, ec);
+    if (estourou) {
+        return "timeout";
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return "falha";
+    }
+
+    std::ifstream in(saida);
+    std::stringstream texto;
+    texto << "\n" << in.rdbuf();
+    const std::string s = texto.str();
+    medida.execucao = LerCampo(s, "Tempo Execução (s)");
+    if (medida.execucao < 0.0) {
+        return "sem perfil";
+    }
+    medida.parede = LerCampo(s, "Tempo Montagem (s)") + LerCampo(s, "Tempo Instalação (s)") + medida.execucao +
+                    LerCampo(s, "Tempo Encerramento (s)");
+    medida.simuladosPorSegundo = LerCampo(s, "Segundos Simulados/s");
+    medida.eventos = static_cast<uint64_t>(LerCampo(s, "Eventos"));
+    medida.eventosPorSegundo = LerCampo(s, "Eventos/s");
+    medida.memoria = LerCampo(s, "Pico de Memória (MB)");
+    return "ok";
+}
+
+// Mediana de cada métrica entre as repetições (eventos são iguais em todas)
+static Ponto Mediana(std::vector<Ponto> medidas) {
+    auto mediana = [&](double Ponto::*campo) {
+        std::sort(medidas.begin(), medidas.end(), [campo](const Ponto& a, const Ponto& b) { return a.*campo < b.*campo; });
+        return medidas[medidas.size() / 2].*campo;
+    };
+    Ponto p = medidas.front();
+    p.repeticoes = medidas.size();
+    p.parede = mediana(&Ponto::parede);
+    p.execucao = mediana(&Ponto::execucao);
+    p.simuladosPorSegundo = mediana(&Ponto::simuladosPorSegundo);
+    p.eventosPorSegundo = mediana(&Ponto::eventosPorSegundo);
+    p.memoria = mediana(&Ponto::memoria);
+    return p;
+}
+
+static void EscreverCabecalho(std::ostream& os) {
+    os << "Binário,Dispositivos,Repetições,Tempo de Parede (s),Tempo Execução (s),Segundos Simulados/s,Eventos,"
+          "Eventos/s,Pico de Memória (MB),Status\n";
+}
+
+static void EscreverPonto(std::ostream& os, const Ponto& p) {
+    os << p.binario << "," << p.dispositivos << "," << p.repeticoes << "," << p.parede << "," << p.execucao << ","
+       << p.simuladosPorSegundo << "," << p.eventos << "," << p.eventosPorSegundo << "," << p.memoria << ","
+       << p.status << "\n";
+}
+
+static std::vector<Ponto> LerPontos(const std::string& arquivo) {
+    std::vector<Ponto> pontos;
+    std::ifstream in(arquivo);
+    std::string linha;
+    std::getline(in, linha); // cabeçalho
+    while (std::getline(in, linha)) {
+        std::stringstream ss(linha);
+        std::vector<std::string> c;
+        std::string campo;
+        while (std::getline(ss, campo, ',')) {
+            c.push_back(campo);
+        }
+        if (c.size() < 10) {
+            continue;
+        }
+        Ponto p;
+        p.binario = c[0];
+        p.dispositivos = std::stoul(c[1]);
+        p.repeticoes = std::stoul(c[2]);
+        p.parede = std::stod(c[3]);
+        p.execucao = std::stod(c[4]);
+        p.simuladosPorSegundo = std::stod(c[5]);
+        p.eventos = std::stoull(c[6]);
+        p.eventosPorSegundo = std::stod(c[7]);
+        p.memoria = std::stod(c[8]);
+        p.status = c[9];
+        pontos.push_back(p);
+    }
+    return pontos;
+}
+
+// Inclinação de log(y) contra log(dispositivos), só com os pontos ok e
+// y > 0 (NAN com menos de dois pontos)
+static double Expoente(const std::vector<Ponto>& pontos, const std::string& binario, double Ponto::*campo) {
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const Ponto& p : pontos) {
+        if (p.binario != binario || p.status != "ok" || p.*campo <= 0.0) {
+            continue;
+        }
+        double x = std::log(double(p.dispositivos));
+        double y = std::log(p.*campo);
+        n++;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double den = n * sxx - sx * sx;
+    return n >= 2 && den > 0.0 ? (n * sxy - sx * sy) / den : NAN;
+}
+
+// Compara com a linha de base; devolve o número de regressões
+static size_t Comparar(const Config& cfg, const std::vector<Ponto>& atuais) {
+    std::vector<Ponto> base = LerPontos(cfg.baseline);
+    if (base.empty()) {
+        std::cerr << "Linha de base vazia ou inexistente: " << cfg.baseline << std::endl;
+        return 1;
+    }
+    size_t regressoes = 0;
+    for (const Ponto& p : atuais) {
+        auto it = std::find_if(base.begin(), base.end(), [&](const Ponto& b) {
+            return b.binario == p.binario && b.dispositivos == p.dispositivos;
+        });
+        if (it == base.end() || it->status != "ok") {
+            continue;
+        }
+        std::ostringstream id;
+        id << p.binario << " (" << p.dispositivos << " dispositivos)";
+        if (p.status != "ok") {
+            std::cout << "   ❌ " << id.str() << ": " << p.status << " (ok na linha de base)" << std::endl;
+            regressoes++;
+            continue;
+        }
+        if (p.parede > it->parede * (1.0 + cfg.tolerancia) && p.parede > cfg.minimoParede) {
+            std::cout << "   ❌ " << id.str() << ": tempo " << it->parede << " -> " << p.parede << " s" << std::endl;
+            regressoes++;
+        }
+        if (p.memoria > it->memoria * (1.0 + cfg.tolerancia)) {
+            std::cout << "   ❌ " << id.str() << ": memória " << it->memoria << " -> " << p.memoria << " MB"
+                      << std::endl;
+            regressoes++;
+        }
+        if (p.eventos != it->eventos) {
+            // Não é regressão de desempenho, mas o modelo mudou: as medidas
+            // deixam de ser comparáveis
+            std::cout << "   ⚠️  " << id.str() << ": eventos " << it->eventos << " -> " << p.eventos << std::endl;
+        }
+    }
+    for (const std::string& bin : cfg.binarios) {
+        double antes = Expoente(base, bin, &Ponto::parede);
+        double agora = Expoente(atuais, bin, &Ponto::parede);
+        if (!std::isnan(antes) && !std::isnan(agora) && agora > antes + cfg.toleranciaExpoente) {
+            std::cout << "   ❌ " << bin << ": expoente do tempo " << antes << " -> " << agora << std::endl;
+            regressoes++;
+        }
+        antes = Expoente(base, bin, &Ponto::memoria);
+        agora = Expoente(atuais, bin, &Ponto::memoria);
+        if (!std::isnan(antes) && !std::isnan(agora) && agora > antes + cfg.toleranciaExpoente) {
+            std::cout << "   ❌ " << bin << ": expoente da memória " << antes << " -> " << agora << std::endl;
+            regressoes++;
+        }
+    }
+    return regressoes;
+}
+
+static std::vector<std::string> SepararTexto(const std::string& lista) {
+    std::vector<std::string> itens;
+    std::stringstream ss(lista);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            itens.push_back(item);
+        }
+    }
+    return itens;
+}
+
+static std::vector<uint32_t> SepararNumeros(const std::string& lista) {
+    std::vector<uint32_t> valores;
+    for (const std::string& item : SepararTexto(lista)) {
+        valores.push_back(static_cast<uint32_t>(std::stoul(item)));
+    }
+    return valores;
+}
+
+static void Uso() {
+    std::cerr << "Uso: lpwan-bench [--ns3=DIR] [--out=DIR] [--bin=lorawan-test,...] [--devices=10,...]\n"
+                 "                  [--repeat=N] [--seed=N] [--distance=M] [--timeout=S]\n"
+                 "                  [--baseline=ARQ] [--save-baseline=ARQ] [--tolerance=F]\n"
+                 "                  [--exponent-tolerance=F] [--cmd-<binário>=MODELO]\n"
+                 "                  [--cap-<binário>=N]  (teto da escada; 0 = sem teto)\n"
+                 "Marcadores do MODELO: {ns3} {cwd} {dist} {dev} {seed}\n"
+                 "Saída: 0 = ok, 2 = falhas de execução, 3 = regressão contra a linha de base\n";
+}
+
+static bool LerArgumentos(int argc, char* argv[], Config& cfg) {
+    const char* home = std::getenv("HOME");
+    cfg.ns3Dir = std::string(home ? home : ".") + "/ns3_test/ns-3-dev";
+    cfg.comandos = ComandosPadrao();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            return false;
+        }
+        std::string chave = arg.substr(2, eq - 2);
+        std::string valor = arg.substr(eq + 1);
+
+        // Número malformado (std::stoul/std::stod) mostra o uso em vez de
+        // derrubar a ferramenta
+        try {
+            if (chave == "ns3") cfg.ns3Dir = valor;
+            else if (chave == "out") cfg.outDir = valor;
+            else if (chave == "bin") cfg.binarios = SepararTexto(valor);
+            else if (chave == "devices") cfg.dispositivos = SepararNumeros(valor);
+            else if (chave == "repeat") cfg.repeat = std::max(1ul, std::stoul(valor));
+            else if (chave == "seed") cfg.seed = std::stoul(valor);
+            else if (chave == "distance") cfg.distancia = std::stoul(valor);
+            else if (chave == "timeout") cfg.timeout = std::stod(valor);
+            else if (chave == "baseline") cfg.baseline = valor;
+            else if (chave == "save-baseline") cfg.saveBaseline = valor;
+            else if (chave == "tolerance") cfg.tolerancia = std::stod(valor);
+            else if (chave == "exponent-tolerance") cfg.toleranciaExpoente = std::stod(valor);
+            else if (chave.rfind("cmd-", 0) == 0) cfg.comandos[chave.substr(4)] = valor;
+            else if (chave.rfind("cap-", 0) == 0) cfg.tetos[chave.substr(4)] = std::stoul(valor);
+            else return false;
+        } catch (const std::exception&) {
+            std::cerr << "Valor inválido em --" << chave << ": " << valor << std::endl;
+            return false;
+        }
+    }
+
+    for (const std::string& bin : cfg.binarios) {
+        if (cfg.comandos.find(bin) == cfg.comandos.end()) {
+            std::cerr << "Binário sem comando: " << bin << std::endl;
+            return false;
+        }
+    }
+    std::sort(cfg.dispositivos.begin(), cfg.dispositivos.end());
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    if (!LerArgumentos(argc, argv, cfg)) {
+        Uso();
+        return 1;
+    }
+
+    fs::create_directories(fs::path(cfg.outDir) / "logs");
+
+    std::cout << "=== BENCHMARK LPWAN ===" << std::endl;
+    std::cout << "Binários: " << cfg.binarios.size() << ", escada: " << cfg.dispositivos.size()
+              << " pontos, repetições: " << cfg.repeat << std::endl;
+
+    std::vector<Ponto> pontos;
+    size_t falhas = 0;
+    for (const std::string& bin : cfg.binarios) {
+        auto teto = cfg.tetos.find(bin);
+        for (uint32_t dev : cfg.dispositivos) {
+            if (teto != cfg.tetos.end() && teto->second > 0 && dev > teto->second) {
+                std::cout << "   ⏭️  " << bin << ": pontos acima de " << teto->second
+                          << " dispositivos fora da escada (teto da série)" << std::endl;
+                break;
+            }
+            std::vector<Ponto> medidas;
+            std::string status = "ok";
+            for (uint32_t r = 0; r < cfg.repeat && status == "ok"; ++r) {
+                Ponto m;
+                m.binario = bin;
+                m.dispositivos = dev;
+                status = ExecutarUma(cfg, bin, dev, m);
+                medidas.push_back(m);
+            }
+            Ponto p = status == "ok" ? Mediana(medidas) : medidas.back();
+            p.repeticoes = medidas.size();
+            p.status = status;
+            pontos.push_back(p);
+            std::cout << (status == "ok" ? "   ✅ " : "   ❌ ") << bin << " " << dev << " dispositivos: ";
+            if (status == "ok") {
+                std::cout << p.parede << " s, " << p.simuladosPorSegundo << " s simulados/s, " << p.eventos
+                          << " eventos, " << p.memoria << " MB" << std::endl;
+            } else {
+                std::cout << status << std::endl;
+                falhas++;
+                break; // os pontos maiores da escada também não terminariam
+            }
+        }
+        std::cout << "   " << bin << ": expoente do tempo " << Expoente(pontos, bin, &Ponto::parede)
+                  << ", expoente da memória " << Expoente(pontos, bin, &Ponto::memoria) << std::endl;
+    }
+
+    const fs::path csv = fs::path(cfg.outDir) / "benchmark.csv";
+    {
+        std::ofstream out(csv);
+        EscreverCabecalho(out);
+        for (const Ponto& p : pontos) {
+            EscreverPonto(out, p);
+        }
+    }
+    std::cout << "Resultados: " << csv.string() << std::endl;
+    if (!cfg.saveBaseline.empty()) {
+        fs::copy_file(csv, cfg.saveBaseline, fs::copy_options::overwrite_existing);
+        std::cout << "Linha de base gravada: " << cfg.saveBaseline << std::endl;
+    }
+
+    if (!cfg.baseline.empty()) {
+        std::cout << "Comparando com " << cfg.baseline << " (tolerância " << cfg.tolerancia * 100 << "%)" << std::endl;
+        size_t regressoes = Comparar(cfg, pontos);
+        std::cout << "Regressões: " << regressoes << std::endl;
+        if (regressoes > 0) {
+            return 3;
+        }
+    }
+    return falhas > 0 ? 2 : 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * Exportador de resultados binários (.lpwr) para CSV
+ *
+ * Lê os arquivos colunares gravados pelos simuladores e pelo lpwan-sweep
+ * (formato em codigos/comum/lpwan-results-bin.h) via mmap e gera o mesmo
+ * CSV que scripts/converter_extendidos_csv.py produzia a partir dos .txt,
+ * sem nenhum parse de texto.
+ *
+ * Compilação (não depende do NS-3):
+ *   g++ -O2 -std=c++17 codigos/ferramentas/lpwan-export.cc -o lpwan-export
+ *
+ * Um diretório contribui só com os .lpwr dele (sem recursão): no diretório
+ * da varredura é o arquivo unificado, e não os shards de <out>/shards/ com as
+ * mesmas linhas. Sem nenhum .lpwr no diretório, usa os de <dir>/shards/.
+ *
+ * Exemplos:
+ *   ./lpwan-export resultados_varredura/                  # arquivo unificado
+ *   ./lpwan-export resultados_varredura/shards/           # shards por execução
+ *   ./lpwan-export --out=csv/resultados.csv --por-tecnologia a.lpwr b.lpwr
+ */
+
+#include "../comum/lpwan-results-bin.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const char* CABECALHO =
+    "Tecnologia,Execução,Distância (m),Dispositivos,Pacotes Enviados,Pacotes Recebidos,"
+    "Pacotes Duplicados,PDR (%),PLR (%),Retransmissão (%),Vazão (bps),Utilização do Canal (%),"
+    "Atraso Médio (s),Atraso p50 (s),Atraso p90 (s),Atraso p99 (s),Atraso Máximo (s),Banda Utilizada (kHz),"
+    "Consumo Energia (J)\n";
+
+// Saída CSV com buffer próprio (uma chamada fwrite a cada ~1 MB)
+class SaidaCsv {
+public:
+    explicit SaidaCsv(const std::string& caminho) : m_caminho(caminho) {
+        m_arquivo = std::fopen(caminho.c_str(), "wb");
+        if (!m_arquivo) {
+            throw std::runtime_error("não foi possível criar " + caminho);
+        }
+        m_buffer.reserve(1 << 20);
+        m_buffer += CABECALHO;
+    }
+
+    ~SaidaCsv() {
+        if (m_arquivo) {
+            try {
+                Fechar();
+            } catch (const std::exception&) {
+                // destrutor não propaga (pode estar desempilhando outra
+                // exceção); chame Fechar() para ver o erro
+                if (m_arquivo) {
+                    std::fclose(m_arquivo);
+                }
+            }
+        }
+    }
+
+    void Linha(const lpwan::ResultsFile& arq, uint64_t i) {
+        char linha[512];
+        const uint64_t* tec = arq.IntColumn(lpwan::COL_TECHNOLOGY);
+        int n = std::snprintf(linha, sizeof(linha), "%s", lpwan::TechnologyName(tec[i]));
+        for (uint32_t c = lpwan::COL_RUN; c < lpwan::NUM_COLUMNS; ++c) {
+            if (lpwan::IsIntegerColumn(c)) {
+                n += std::snprintf(linha + n, sizeof(linha) - n, ",%llu",
+                                   static_cast<unsigned long long>(arq.IntColumn(c)[i]));
+            } else {
+                n += std::snprintf(linha + n, sizeof(linha) - n, ",%.10g", arq.RealColumn(c)[i]);
+            }
+        }
+        m_buffer.append(linha, n);
+        m_buffer += '\n';
+        m_linhas++;
+        if (m_buffer.size() >= (1 << 20)) {
+            Descarregar();
+        }
+    }
+
+    void Fechar() {
+        Descarregar();
+        if (std::fclose(m_arquivo) != 0) {
+            m_arquivo = nullptr;
+            throw std::runtime_error("falha ao gravar " + m_caminho);
+        }
+        m_arquivo = nullptr;
+    }
+
+    uint64_t GetLinhas() const { return m_linhas; }
+    const std::string& GetCaminho() const { return m_caminho; }
+
+private:
+    void Descarregar() {
+        if (!m_buffer.empty() && std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_arquivo) != m_buffer.size()) {
+            throw std::runtime_error("falha ao gravar " + m_caminho);
+        }
+        m_buffer.clear();
+    }
+
+    std::string m_caminho;
+    FILE* m_arquivo = nullptr;
+    std::string m_buffer;
+    uint64_t m_linhas = 0;
+};
+
+// Arquivos .lpwr direto em `dir` (sem subdiretórios), em ordem estável
+static std::vector<std::string> ArquivosDoDiretorio(const fs::path& dir) {
+    std::vector<std::string> arquivos;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(dir, ec)) {
+        if (item.is_regular_file() && item.path().extension() == ".lpwr") {
+            arquivos.push_back(item.path().string());
+        }
+    }
+    std::sort(arquivos.begin(), arquivos.end());
+    return arquivos;
+}
+
+// Expande diretórios em arquivos .lpwr. Sem recursão: o diretório da
+// varredura tem o unificado e, em shards/, as mesmas linhas de novo
+static std::vector<std::string> ListarArquivos(const std::vector<std::string>& entradas) {
+    std::vector<std::string> arquivos;
+    for (const std::string& entrada : entradas) {
+        if (fs::is_directory(entrada)) {
+            std::vector<std::string> doDiretorio = ArquivosDoDiretorio(entrada);
+            if (doDiretorio.empty()) {
+                doDiretorio = ArquivosDoDiretorio(fs::path(entrada) / "shards");
+            }
+            arquivos.insert(arquivos.end(), doDiretorio.begin(), doDiretorio.end());
+        } else {
+            arquivos.push_back(entrada);
+        }
+    }
+    return arquivos;
+}
+
+static void Uso() {
+    std::cerr << "Uso: lpwan-export [--out=ARQ.csv] [--por-tecnologia] ARQUIVO.lpwr|DIRETÓRIO...\n"
+                 "  --out             CSV com todas as linhas (padrão: resultados_extendidos_completo.csv)\n"
+                 "  --por-tecnologia  gera também resultados_extendidos_<tecnologia>.csv no diretório do --out\n"
+                 "Diretórios: só os .lpwr de primeiro nível (ou os de <dir>/shards/, se não houver nenhum)\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string saida = "resultados_extendidos_completo.csv";
+    bool porTecnologia = false;
+    std::vector<std::string> entradas;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--out=", 0) == 0) {
+            saida = arg.substr(6);
+        } else if (arg == "--por-tecnologia") {
+            porTecnologia = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            Uso();
+            return 1;
+        } else {
+            entradas.push_back(arg);
+        }
+    }
+    if (entradas.empty()) {
+        Uso();
+        return 1;
+    }
+
+    const auto inicio = std::chrono::steady_clock::now();
+    std::vector<std::string> arquivos = ListarArquivos(entradas);
+    if (arquivos.empty()) {
+        std::cerr << "❌ Nenhum arquivo .lpwr encontrado" << std::endl;
+        return 1;
+    }
+
+    std::cout << "=== EXPORTAÇÃO DE RESULTADOS BINÁRIOS PARA CSV ===" << std::endl;
+    std::cout << "📁 Arquivos: " << arquivos.size() << std::endl;
+
+    try {
+        SaidaCsv completo(saida);
+        std::map<uint64_t, SaidaCsv> separados;
+        size_t erros = 0;
+
+        for (const std::string& caminho : arquivos) {
+            lpwan::ResultsFile arq;
+            try {
+                arq.Open(caminho);
+            } catch (const std::exception& e) {
+                std::cerr << "⚠️  " << e.what() << std::endl;
+                erros++;
+                continue;
+            }
+            const uint64_t* tec = arq.IntColumn(lpwan::COL_TECHNOLOGY);
+            for (uint64_t i = 0; i < arq.GetNumRows(); ++i) {
+                completo.Linha(arq, i);
+                if (porTecnologia) {
+                    auto it = separados.find(tec[i]);
+                    if (it == separados.end()) {
+                        std::string nome = lpwan::TechnologyName(tec[i]);
+                        nome.erase(std::remove(nome.begin(), nome.end(), '-'), nome.end());
+                        std::transform(nome.begin(), nome.end(), nome.begin(), ::tolower);
+                        fs::path caminho = fs::path(saida).parent_path() / ("resultados_extendidos_" + nome + ".csv");
+                        it = separados.emplace(tec[i], caminho.string()).first;
+                    }
+                    it->second.Linha(arq, i);
+                }
+            }
+        }
+
+        completo.Fechar();
+        std::cout << "✅ CSV principal salvo: " << saida << " (" << completo.GetLinhas() << " registros)" << std::endl;
+        for (auto& par : separados) {
+            par.second.Fechar();
+            std::cout << "✅ CSV " << lpwan::TechnologyName(par.first) << ": " << par.second.GetCaminho() << " ("
+                      << par.second.GetLinhas() << " registros)" << std::endl;
+        }
+        if (erros > 0) {
+            std::cout << "⚠️  Arquivos ignorados: " << erros << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ " << e.what() << std::endl;
+        return 1;
+    }
+
+    double decorrido = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    std::cout << "⏱️  Tempo: " << decorrido << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,707 @@
+/*
+ * Executor paralelo da varredura LPWAN (distância × dispositivos × execução)
+ *
+ * Dispara os binários NS-3 reais (lorawan-test, nb-iot-sim e
+ * sigfox_simulacao_explicada) num pool de threads com roubo de trabalho,
+ * dimensionado pelo número de núcleos da máquina. Os pontos mais caros
+ * (30000/50000 dispositivos) são escalonados primeiro, cada ponto concluído é
+ * gravado de forma atômica (rename) e, ao final, todos os blocos são
+ * concatenados num único arquivo de resultados. Os shards de cada ponto
+ * (CSV + .lpwr, ver comum/lpwan-result-sink.h) vão para <out>/shards/ e as
+ * linhas binárias são reunidas num único arquivo colunar ao lado do
+ * unificado em texto.
+ *
+ * Com --ci-target o número de execuções deixa de ser fixo: cada ponto começa
+ * com --min-runs execuções e, quando todas terminam, ganha mais execuções
+ * enquanto a semiamplitude relativa do IC 95% de alguma métrica de
+ * --ci-metrics estiver acima do alvo, até --max-runs (comum/lpwan-stopping.h).
+ * Quantas execuções cada ponto precisou vai para <out>/execucoes_por_ponto.csv.
+ *
+ * Compilação (não depende do NS-3):
+ *   g++ -O2 -std=c++17 -pthread codigos/ferramentas/lpwan-sweep.cc -o lpwan-sweep
+ *
+ * Exemplo:
+ *   ./lpwan-sweep --ns3=$HOME/ns3_test/ns-3-dev --out=resultados_varredura
+ *   ./lpwan-sweep --ci-target=0.05 --min-runs=3 --max-runs=30
+ */
+
+#include "../comum/lpwan-results-bin.h"
+#include "../comum/lpwan-stopping.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Um ponto da grade: (tecnologia, distância, dispositivos, execução)
+struct Job {
+    std::string tecnologia;
+    uint32_t distancia;
+    uint32_t dispositivos;
+    uint32_t execucao;
+    double custo;
+};
+
+// Configuração da varredura (valores padrão = grade estendida)
+struct Config {
+    std::string ns3Dir;
+    std::string outDir = "resultados_varredura";
+    std::string merged;
+    uint32_t jobs = 0;
+    uint32_t execucoes = 10;
+    uint32_t seedBase = 12345;
+    lpwan::SequentialStopping parada; // alvo > 0: execuções por ponto pelo IC
+    std::vector<lpwan::StoppingMetric> metricasIc;
+    std::vector<std::string> tecnologias = {"lorawan", "nbiot", "sigfox"};
+    std::vector<uint32_t> distancias = {3000, 5000, 10000, 15000, 30000, 50000};
+    std::vector<uint32_t> dispositivos = {10, 100, 500, 1000, 5000, 10000, 30000, 50000};
+    std::map<std::string, std::string> comandos;
+};
+
+// Linhas de comando padrão por tecnologia. Marcadores substituídos em
+// ExpandirComando: {ns3} {cwd} {dist} {dev} {run} {seed} {nbiot-model}
+// ({nbiot-model}: lte até a capacidade da célula LTE do nb-iot-sim, reduced
+// acima dela)
+static std::map<std::string, std::string> ComandosPadrao() {
+    return {
+        {"lorawan", "{ns3}/ns3 run --no-build --cwd={cwd} \"lorawan-test --distance={dist} "
+                    "--deviceCount={dev} --runSeed={seed} --firstRun={run} --numExecutions=1\""},
+        {"nbiot", "{ns3}/ns3 run --no-build --cwd={cwd} \"nb-iot-sim --distance={dist} "
+                  "--nUe={dev} --model={nbiot-model} --RngSeed={seed} --RngRun={run}\""},
+        {"sigfox", "{ns3}/ns3 run --no-build --cwd={cwd} \"sigfox_simulacao_explicada "
+                   "--distance={dist} --nDevices={dev} --RngSeed={seed} --RngRun={run}\""},
+    };
+}
+
+// Estimativa relativa de custo: domina o número de dispositivos (eventos por
+// transmissão crescem com a densidade); a distância só desempata.
+static double EstimarCusto(const Job& job) {
+    double fator = (job.tecnologia == "nbiot") ? 4.0 : 1.0; // pilha LTE/EPC completa
+    return fator * double(job.dispositivos) * double(job.dispositivos + 1) + job.distancia * 1e-3;
+}
+
+static std::string NomeJob(const Job& job) {
+    std::ostringstream nome;
+    nome << "resultados_" << job.tecnologia << "_" << job.distancia << "m_"
+         << job.dispositivos << "dev_" << job.execucao;
+    return nome.str();
+}
+
+static void Substituir(std::string& texto, const std::string& chave, const std::string& valor) {
+    for (size_t pos = texto.find(chave); pos != std::string::npos; pos = texto.find(chave, pos + valor.size())) {
+        texto.replace(pos, chave.size(), valor);
+    }
+}
+
+// Maior número de UEs que o nb-iot-sim aceita no modelo lte (SRS da célula)
+static const uint32_t NBIOT_LTE_MAX_UES = 320;
+
+static std::string ExpandirComando(const Config& cfg, const Job& job, const std::string& cwd) {
+    std::string cmd = cfg.comandos.at(job.tecnologia);
+    Substituir(cmd, "{ns3}", cfg.ns3Dir);
+    Substituir(cmd, "{cwd}", cwd);
+    Substituir(cmd, "{dist}", std::to_string(job.distancia));
+    Substituir(cmd, "{dev}", std::to_string(job.dispositivos));
+    Substituir(cmd, "{run}", std::to_string(job.execucao));
+    Substituir(cmd, "{seed}", std::to_string(cfg.seedBase));
+    Substituir(cmd, "{nbiot-model}", job.dispositivos <= NBIOT_LTE_MAX_UES ? "lte" : "reduced");
+    return cmd;
+}
+
+// Fila por worker: o dono consome pela frente (maior custo), ladrões pelo fundo.
+// Jobs podem ser acrescentados durante a varredura (execuções extras do
+// critério pelo IC), então um worker sem trabalho só termina quando não há
+// nada na fila nem em execução.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(uint32_t nWorkers) : m_filas(nWorkers) {}
+
+    // Distribui os jobs (já ordenados por custo decrescente) em round-robin,
+    // de modo que cada fila também fique em ordem decrescente.
+    void Distribuir(const std::vector<Job>& jobs) {
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            Adicionar(i % m_filas.size(), jobs[i], false);
+        }
+    }
+
+    // Acrescenta na frente da fila do worker (ex.: o que concluiu o ponto)
+    void Adicionar(uint32_t worker, const Job& job, bool frente = true) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_restantes++;
+            m_versao++;
+        }
+        {
+            Fila& fila = m_filas[worker];
+            std::lock_guard<std::mutex> lock(fila.mutex);
+            if (frente) {
+                fila.jobs.push_front(job);
+            } else {
+                fila.jobs.push_back(job);
+            }
+        }
+        m_cv.notify_all();
+    }
+
+    // Chamado depois de cada job (e de acrescentar os que ele gerou)
+    void Concluir() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_restantes--;
+            m_versao++;
+        }
+        m_cv.notify_all();
+    }
+
+    bool Proximo(uint32_t worker, Job& job) {
+        for (;;) {
+            uint64_t versao;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                versao = m_versao;
+            }
+            if (Tirar(worker, job)) {
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_restantes == 0) {
+                return false;
+            }
+            m_cv.wait(lock, [&]() { return m_versao != versao || m_restantes == 0; });
+        }
+    }
+
+private:
+    bool Tirar(uint32_t worker, Job& job) {
+        {
+            Fila& propria = m_filas[worker];
+            std::lock_guard<std::mutex> lock(propria.mutex);
+            if (!propria.jobs.empty()) {
+                job = propria.jobs.front();
+                propria.jobs.pop_front();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < m_filas.size(); ++k) {
+            Fila& vitima = m_filas[(worker + k) % m_filas.size()];
+            std::lock_guard<std::mutex> lock(vitima.mutex);
+            if (!vitima.jobs.empty()) {
+                job = vitima.jobs.back();
+                vitima.jobs.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Fila {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+    std::vector<Fila> m_filas;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    uint64_t m_restantes = 0; // na fila ou em execução
+    uint64_t m_versao = 0;    // muda a cada job acrescentado ou concluído
+};
+
+// Executa um job num diretório próprio (isola arquivos auxiliares como
+// bateria_sigfox_*.lpwb). A saída só vira <nome>.txt depois do rename.
+static bool ExecutarJob(const Config& cfg, const Job& job) {
+    const std::string nome = NomeJob(job);
+    const fs::path cwd = fs::absolute(fs::path(cfg.outDir) / "tmp" / nome);
+    const fs::path parcial = fs::path(cfg.outDir) / (nome + ".txt.part");
+    const fs::path final = fs::path(cfg.outDir) / (nome + ".txt");
+    const fs::path log = fs::path(cfg.outDir) / "logs" / (nome + ".log");
+
+    fs::create_directories(cwd);
+    const std::string cmd = ExpandirComando(cfg, job, cwd.string());
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        int out = open(parcial.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        int err = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0 || err < 0 || chdir(cwd.c_str()) != 0) {
+            _exit(127);
+        }
+        dup2(out, STDOUT_FILENO);
+        dup2(err, STDERR_FILENO);
+        execl("/bin/sh", "sh", "-c", cmd.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    if (pid < 0) {
+        return false;
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+
+    // Os shards têm nome único por (tecnologia, configuração, semente,
+    // execução), então todos os jobs podem ir para o mesmo diretório. A
+    // (tecnologia, configuração) de cada .lpwr fica em <nome>.config, para o
+    // arquivo unificado só juntar shards da grade atual
+    std::error_code ec;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        std::ofstream config(fs::path(cfg.outDir) / "shards" / (nome + ".config"));
+        for (const auto& item : fs::directory_iterator(cwd, ec)) {
+            const fs::path ext = item.path().extension();
+            if (ext == ".lpwr") {
+                try {
+                    lpwan::ResultsFile arq(item.path().string());
+                    if (arq.GetNumRows() > 0) {
+                        config << arq.GetTechnology(0) << " " << arq.Header().meta.configHash << "\n";
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "⚠️  " << e.what() << std::endl;
+                }
+            }
+            if (ext == ".lpwr" || ext == ".csv") {
+                fs::rename(item.path(), fs::path(cfg.outDir) / "shards" / item.path().filename(), ec);
+            }
+        }
+    }
+    fs::remove_all(cwd, ec);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return false;
+    }
+
+    // Só aceita a saída se contiver o bloco padronizado de resultados
+    std::ifstream in(parcial);
+    std::string linha;
+    bool temBloco = false;
+    while (std::getline(in, linha)) {
+        if (linha.rfind("=== RESULTADOS", 0) == 0) {
+            temBloco = true;
+            break;
+        }
+    }
+    if (!temBloco) {
+        return false;
+    }
+    fs::rename(parcial, final);
+    return true;
+}
+
+// Concatena os blocos concluídos na ordem canônica da grade
+static size_t GerarArquivoUnificado(const Config& cfg, const std::vector<Job>& grade) {
+    const fs::path tmp = cfg.merged + ".tmp";
+    std::ofstream out(tmp, std::ios::binary);
+    size_t blocos = 0;
+    for (const Job& job : grade) {
+        std::ifstream in(fs::path(cfg.outDir) / (NomeJob(job) + ".txt"), std::ios::binary);
+        if (!in) {
+            continue;
+        }
+        out << in.rdbuf();
+        blocos++;
+    }
+    out.close();
+    fs::rename(tmp, cfg.merged);
+    return blocos;
+}
+
+// Reúne as linhas dos shards .lpwr desta semente num único arquivo colunar
+// (<merged> com extensão .lpwr), na ordem canônica da grade. Só entram shards
+// cuja (tecnologia, configuração) saiu de um job da grade atual e linhas de
+// pontos (distância, dispositivos, execução) da grade: shards de varreduras
+// anteriores no mesmo <out>/shards/ ficam de fora
+static size_t GerarBinarioUnificado(const Config& cfg, const std::vector<Job>& grade) {
+    struct Linha {
+        uint64_t tecnologia;
+        lpwan::RunResult r;
+    };
+    std::set<std::pair<uint64_t, uint64_t>> configuracoes;
+    std::set<std::tuple<uint64_t, uint32_t, uint32_t>> pontos;
+    for (const Job& job : grade) {
+        std::ifstream in(fs::path(cfg.outDir) / "shards" / (NomeJob(job) + ".config"));
+        uint64_t tecnologia, hash;
+        while (in >> tecnologia >> hash) {
+            configuracoes.emplace(tecnologia, hash);
+        }
+        pontos.emplace(uint64_t(job.distancia), job.dispositivos, job.execucao);
+    }
+
+    std::vector<Linha> linhas;
+    std::error_code ec;
+    for (const auto& item : fs::directory_iterator(fs::path(cfg.outDir) / "shards", ec)) {
+        if (item.path().extension() != ".lpwr") {
+            continue;
+        }
+        try {
+            lpwan::ResultsFile arq(item.path().string());
+            if (arq.Header().meta.seed != cfg.seedBase) {
+                continue;
+            }
+            for (uint64_t i = 0; i < arq.GetNumRows(); ++i) {
+                lpwan::RunResult r = arq.GetRow(i);
+                if (configuracoes.count({arq.GetTechnology(i), arq.Header().meta.configHash}) == 0 ||
+                    pontos.count({uint64_t(r.distance + 0.5), r.devices, r.run}) == 0) {
+                    continue;
+                }
+                linhas.push_back(Linha{arq.GetTechnology(i), r});
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "⚠️  " << e.what() << std::endl;
+        }
+    }
+    std::sort(linhas.begin(), linhas.end(), [](const Linha& a, const Linha& b) {
+        if (a.tecnologia != b.tecnologia) return a.tecnologia < b.tecnologia;
+        if (a.r.distance != b.r.distance) return a.r.distance < b.r.distance;
+        if (a.r.devices != b.r.devices) return a.r.devices < b.r.devices;
+        return a.r.run < b.r.run;
+    });
+
+    std::vector<uint64_t> tecnologias;
+    std::vector<lpwan::RunResult> resultados;
+    for (const Linha& l : linhas) {
+        tecnologias.push_back(l.tecnologia);
+        resultados.push_back(l.r);
+    }
+    const std::string destino = fs::path(cfg.merged).replace_extension(".lpwr").string();
+    lpwan::WriteResultsFile(destino, lpwan::MakeResultsMetadata("lpwan-sweep", cfg.seedBase, 0.0), tecnologias,
+                            resultados);
+    return resultados.size();
+}
+
+// Estado do critério pelo IC num ponto (tecnologia, distância, dispositivos)
+struct Ponto {
+    Job base;               // execucao = 0
+    uint32_t lancadas = 0;  // execuções 1..lancadas na fila ou concluídas
+    uint32_t pendentes = 0; // lançadas e ainda não concluídas
+};
+
+static std::string ChavePonto(const Job& job) {
+    return job.tecnologia + "_" + std::to_string(job.distancia) + "_" + std::to_string(job.dispositivos);
+}
+
+// Valores das métricas do critério no bloco de resultados de um job
+// concluído; falso se o arquivo não existe ou falta alguma métrica
+static bool LerMetricas(const Config& cfg, const Job& job, std::vector<double>& valores) {
+    std::ifstream in(fs::path(cfg.outDir) / (NomeJob(job) + ".txt"));
+    if (!in) {
+        return false;
+    }
+    valores.assign(cfg.metricasIc.size(), 0.0);
+    std::vector<bool> lidas(cfg.metricasIc.size(), false);
+    std::string linha;
+    while (std::getline(in, linha)) {
+        for (size_t m = 0; m < cfg.metricasIc.size(); ++m) {
+            const std::string rotulo = std::string(cfg.metricasIc[m].label) + ": ";
+            if (!lidas[m] && linha.rfind(rotulo, 0) == 0) {
+                valores[m] = std::strtod(linha.c_str() + rotulo.size(), nullptr);
+                lidas[m] = true;
+            }
+        }
+    }
+    return std::all_of(lidas.begin(), lidas.end(), [](bool b) { return b; });
+}
+
+// Uma amostra por métrica com as execuções concluídas do ponto
+static std::vector<std::vector<double>> AmostrasPonto(const Config& cfg, const Ponto& ponto) {
+    std::vector<std::vector<double>> amostras(cfg.metricasIc.size());
+    std::vector<double> valores;
+    for (uint32_t run = 1; run <= ponto.lancadas; ++run) {
+        Job job = ponto.base;
+        job.execucao = run;
+        if (LerMetricas(cfg, job, valores)) {
+            for (size_t m = 0; m < valores.size(); ++m) {
+                amostras[m].push_back(valores[m]);
+            }
+        }
+    }
+    return amostras;
+}
+
+// Próximas execuções do ponto, chamada quando nenhuma está pendente (vazio =
+// convergiu ou chegou a --max-runs; execuções que falharam contam no limite)
+static std::vector<Job> ProximasExecucoes(const Config& cfg, Ponto& ponto) {
+    uint32_t mais = cfg.parada.More(AmostrasPonto(cfg, ponto));
+    mais = std::min(mais, cfg.parada.maxRuns - std::min(ponto.lancadas, cfg.parada.maxRuns));
+    std::vector<Job> jobs;
+    for (uint32_t i = 0; i < mais; ++i) {
+        Job job = ponto.base;
+        job.execucao = ++ponto.lancadas;
+        jobs.push_back(job);
+    }
+    ponto.pendentes += mais;
+    return jobs;
+}
+
+// Execuções, convergência e média ± IC de cada métrica por ponto
+static void GerarRelatorioExecucoes(const Config& cfg, const std::map<std::string, Ponto>& pontos,
+                                    const std::vector<Job>& ordem) {
+    const fs::path destino = fs::path(cfg.outDir) / "execucoes_por_ponto.csv";
+    std::ofstream csv(destino);
+    csv << "Tecnologia,Distância (m),Dispositivos,Execuções,Execuções Válidas,Convergiu,Semiamplitude Relativa (%)";
+    for (const lpwan::StoppingMetric& m : cfg.metricasIc) {
+        csv << "," << m.label << " Média," << m.label << " IC95";
+    }
+    csv << "\n";
+    for (const Job& base : ordem) {
+        const Ponto& ponto = pontos.at(ChavePonto(base));
+        std::vector<std::vector<double>> amostras = AmostrasPonto(cfg, ponto);
+        csv << base.tecnologia << "," << base.distancia << "," << base.dispositivos << "," << ponto.lancadas << ","
+            << amostras.front().size() << "," << (cfg.parada.Converged(amostras) ? 1 : 0) << ","
+            << lpwan::SequentialStopping::Worst(amostras) * 100;
+        for (const std::vector<double>& valores : amostras) {
+            lpwan::MetricSummary resumo = lpwan::Summarize(valores);
+            csv << "," << resumo.mean << "," << resumo.halfWidth;
+        }
+        csv << "\n";
+    }
+    std::cout << "Execuções por ponto: " << destino.string() << std::endl;
+}
+
+static std::vector<std::string> SepararTexto(const std::string& lista) {
+    std::vector<std::string> itens;
+    std::stringstream ss(lista);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            itens.push_back(item);
+        }
+    }
+    return itens;
+}
+
+static std::vector<uint32_t> SepararNumeros(const std::string& lista) {
+    std::vector<uint32_t> valores;
+    for (const std::string& item : SepararTexto(lista)) {
+        valores.push_back(static_cast<uint32_t>(std::stoul(item)));
+    }
+    return valores;
+}
+
+static void Uso() {
+    std::cerr << "Uso: lpwan-sweep [--ns3=DIR] [--out=DIR] [--merged=ARQ] [--jobs=N]\n"
+                 "                  [--runs=N] [--seed=N] [--tech=lorawan,nbiot,sigfox]\n"
+                 "                  [--distances=3000,...] [--devices=10,...]\n"
+                 "                  [--ci-target=0.05] [--min-runs=N] [--max-runs=N]\n"
+                 "                  [--ci-metrics=pdr,delay,energy]\n"
+                 "                  [--cmd-<tecnologia>=MODELO]\n"
+                 "Marcadores do MODELO: {ns3} {cwd} {dist} {dev} {run} {seed} {nbiot-model}\n";
+}
+
+static bool LerArgumentos(int argc, char* argv[], Config& cfg) {
+    const char* home = std::getenv("HOME");
+    cfg.ns3Dir = std::string(home ? home : ".") + "/ns3_test/ns-3-dev";
+    cfg.comandos = ComandosPadrao();
+    std::string metricasIc = "pdr,delay,energy";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            return false;
+        }
+        std::string chave = arg.substr(2, eq - 2);
+        std::string valor = arg.substr(eq + 1);
+
+        // Número malformado (std::stoul/std::stod) mostra o uso em vez de
+        // derrubar a ferramenta
+        try {
+            if (chave == "ns3") cfg.ns3Dir = valor;
+            else if (chave == "out") cfg.outDir = valor;
+            else if (chave == "merged") cfg.merged = valor;
+            else if (chave == "jobs") cfg.jobs = std::stoul(valor);
+            else if (chave == "runs") cfg.execucoes = std::stoul(valor);
+            else if (chave == "seed") cfg.seedBase = std::stoul(valor);
+            else if (chave == "tech") cfg.tecnologias = SepararTexto(valor);
+            else if (chave == "distances") cfg.distancias = SepararNumeros(valor);
+            else if (chave == "devices") cfg.dispositivos = SepararNumeros(valor);
+            else if (chave == "ci-target") cfg.parada.target = std::stod(valor);
+            else if (chave == "min-runs") cfg.parada.minRuns = std::stoul(valor);
+            else if (chave == "max-runs") cfg.parada.maxRuns = std::stoul(valor);
+            else if (chave == "ci-metrics") metricasIc = valor;
+            else if (chave.rfind("cmd-", 0) == 0) cfg.comandos[chave.substr(4)] = valor;
+            else return false;
+        } catch (const std::exception&) {
+            std::cerr << "Valor inválido em --" << chave << ": " << valor << std::endl;
+            return false;
+        }
+    }
+
+    for (const std::string& tec : cfg.tecnologias) {
+        if (cfg.comandos.find(tec) == cfg.comandos.end()) {
+            std::cerr << "Tecnologia sem comando: " << tec << std::endl;
+            return false;
+        }
+    }
+    try {
+        cfg.metricasIc = lpwan::ParseStoppingMetrics(metricasIc);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+    if (cfg.parada.Enabled() && cfg.parada.maxRuns < std::max<uint32_t>(cfg.parada.minRuns, 2)) {
+        std::cerr << "--max-runs precisa ser pelo menos --min-runs (e 2)" << std::endl;
+        return false;
+    }
+    if (cfg.jobs == 0) {
+        cfg.jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (cfg.merged.empty()) {
+        cfg.merged = (fs::path(cfg.outDir) / "resultados_varredura.txt").string();
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    if (!LerArgumentos(argc, argv, cfg)) {
+        Uso();
+        return 1;
+    }
+
+    fs::create_directories(fs::path(cfg.outDir) / "logs");
+    fs::create_directories(fs::path(cfg.outDir) / "shards");
+
+    // Pontos (tecnologia, distância, dispositivos) na ordem canônica
+    std::vector<Job> ordem;
+    for (const std::string& tec : cfg.tecnologias) {
+        for (uint32_t dist : cfg.distancias) {
+            for (uint32_t dev : cfg.dispositivos) {
+                Job job{tec, dist, dev, 0, 0.0};
+                job.custo = EstimarCusto(job);
+                ordem.push_back(job);
+            }
+        }
+    }
+
+    // Grade completa na ordem canônica (usada também para o arquivo
+    // unificado). Com o critério pelo IC a grade só é conhecida no fim
+    std::vector<Job> grade;
+    std::vector<Job> pendentes;
+    std::map<std::string, Ponto> pontos;
+    if (cfg.parada.Enabled()) {
+        // Retomada: as execuções 1..k com <nome>.txt já contam na amostra
+        for (const Job& base : ordem) {
+            Ponto& ponto = pontos[ChavePonto(base)];
+            ponto.base = base;
+            Job job = base;
+            for (job.execucao = 1; fs::exists(fs::path(cfg.outDir) / (NomeJob(job) + ".txt")); ++job.execucao) {
+                ponto.lancadas = job.execucao;
+            }
+            for (const Job& novo : ProximasExecucoes(cfg, ponto)) {
+                pendentes.push_back(novo);
+            }
+        }
+    } else {
+        for (const Job& base : ordem) {
+            for (uint32_t run = 1; run <= cfg.execucoes; ++run) {
+                Job job = base;
+                job.execucao = run;
+                grade.push_back(job);
+            }
+        }
+
+        // Retomada: pontos com <nome>.txt já foram concluídos numa execução anterior
+        for (const Job& job : grade) {
+            if (!fs::exists(fs::path(cfg.outDir) / (NomeJob(job) + ".txt"))) {
+                pendentes.push_back(job);
+            }
+        }
+    }
+    std::stable_sort(pendentes.begin(), pendentes.end(),
+                     [](const Job& a, const Job& b) { return a.custo > b.custo; });
+
+    std::cout << "=== VARREDURA LPWAN ===" << std::endl;
+    if (cfg.parada.Enabled()) {
+        std::cout << "Pontos: " << ordem.size() << " (IC ±" << cfg.parada.target * 100 << " %, "
+                  << cfg.parada.minRuns << "-" << cfg.parada.maxRuns << " execuções)" << std::endl;
+        std::cout << "Execuções iniciais: " << pendentes.size() << std::endl;
+    } else {
+        std::cout << "Pontos na grade: " << grade.size() << std::endl;
+        std::cout << "Já concluídos: " << grade.size() - pendentes.size() << std::endl;
+    }
+    std::cout << "Workers: " << cfg.jobs << std::endl;
+
+    WorkStealingPool pool(cfg.jobs);
+    pool.Distribuir(pendentes);
+
+    std::atomic<size_t> concluidos{0};
+    std::atomic<size_t> total{pendentes.size()};
+    std::atomic<size_t> falhas{0};
+    std::mutex logMutex;
+    std::mutex pontosMutex;
+    const auto inicio = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (uint32_t w = 0; w < cfg.jobs; ++w) {
+        workers.emplace_back([&, w]() {
+            Job job;
+            while (pool.Proximo(w, job)) {
+                bool ok = ExecutarJob(cfg, job);
+                if (!ok) {
+                    falhas++;
+                }
+
+                // Último job pendente do ponto: decide se ele precisa de mais execuções
+                if (cfg.parada.Enabled()) {
+                    std::lock_guard<std::mutex> lock(pontosMutex);
+                    Ponto& ponto = pontos.at(ChavePonto(job));
+                    if (--ponto.pendentes == 0) {
+                        for (const Job& novo : ProximasExecucoes(cfg, ponto)) {
+                            pool.Adicionar(w, novo);
+                            total++;
+                        }
+                    }
+                }
+                pool.Concluir();
+
+                size_t feitos = ++concluidos;
+                double decorrido = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+                std::lock_guard<std::mutex> lock(logMutex);
+                std::cout << (ok ? "   ✅ " : "   ❌ ") << NomeJob(job) << " (" << feitos << "/" << total << ", "
+                          << decorrido << " s)" << std::endl;
+            }
+        });
+    }
+    for (std::thread& t : workers) {
+        t.join();
+    }
+
+    if (cfg.parada.Enabled()) {
+        for (const Job& base : ordem) {
+            for (uint32_t run = 1; run <= pontos.at(ChavePonto(base)).lancadas; ++run) {
+                Job job = base;
+                job.execucao = run;
+                grade.push_back(job);
+            }
+        }
+        GerarRelatorioExecucoes(cfg, pontos, ordem);
+    }
+
+    size_t blocos = GerarArquivoUnificado(cfg, grade);
+    std::cout << "Falhas: " << falhas << std::endl;
+    std::cout << "Blocos no arquivo unificado: " << blocos << "/" << grade.size() << std::endl;
+    std::cout << "Arquivo unificado: " << cfg.merged << std::endl;
+    size_t linhas = GerarBinarioUnificado(cfg, grade);
+    std::cout << "Linhas no arquivo binário: " << linhas << " ("
+              << fs::path(cfg.merged).replace_extension(".lpwr").string() << ")" << std::endl;
+
+    return falhas > 0 ? 2 : 0;
+}
@@ -1,217 +1,751 @@
 #include "ns3/command-line.h"
-#include "ns3/constant-position-mobility-model.h"
 #include "ns3/end-device-lora-phy.h"
 #include "ns3/end-device-lorawan-mac.h"
 #include "ns3/gateway-lora-phy.h"
 #include "ns3/gateway-lorawan-mac.h"
 #include "ns3/log.h"
 #include "ns3/lora-helper.h"
-#include "ns3/mobility-helper.h"
 #include "ns3/node-container.h"
 #include "ns3/one-shot-sender-helper.h"
-#include "ns3/position-allocator.h"
 #include "ns3/simulator.h"
 #include "ns3/logical-lora-channel-helper.h"
 #include "ns3/rng-seed-manager.h"
 #include "ns3/energy-module.h"
+#include "../comum/lpwan-metrics.h"
+#include "../comum/lpwan-uid-tracker.h"
+#include "../comum/lpwan-replication.h"
+#include "../comum/lpwan-run-result.h"
+#include "../comum/lpwan-result-sink.h"
+#include "../comum/lpwan-lorawan-analytic.h"
+#include "../comum/lpwan-traffic.h"
+#include "../comum/lpwan-interference.h"
+#include "../comum/lpwan-lora-channel.h"
+#include "../comum/lpwan-placement.h"
+#include "../comum/lpwan-link-budget.h"
+#include "../comum/lpwan-radio-energy.h"
+#include "../comum/lpwan-profile.h"
+#include "../comum/lpwan-stopping.h"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <vector>
-#include <set>
-#include <unordered_map>
 
 using namespace ns3;
 using namespace lorawan;
 
 NS_LOG_COMPONENT_DEFINE("SimpleLorawanNetworkExample");
 
-// Variáveis para armazenar métricas
-uint32_t packetsSent;
-uint32_t packetsReceived;
-uint32_t duplicatedPackets;
-double totalBytesReceived;
-double totalTransmitTime;
-Time totalDelay;
-std::set<uint32_t> receivedUids;
-std::unordered_map<uint32_t, Time> sentTimes;
+// Métricas por dispositivo (índice = id do nó - id do primeiro end device)
+lpwan::MetricsStore metrics;
+lpwan::UidTracker uidTracker;
+uint32_t firstDeviceId = 0;
+uint32_t firstGatewayId = 0;
 
-// Variáveis de energia
-double totalEnergyConsumption = 0.0;
-double initialEnergy = 3600.0; // Joules
+// Servidor de rede: recepções únicas e redundantes por gateway
+std::vector<uint64_t> gatewayUnique;
+std::vector<uint64_t> gatewayRedundant;
+
+// Perdas por causa: traces do PHY do gateway + rastreador de sobreposição
+lpwan::InterferenceTracker interference;
+lpwan::LossBreakdown losses;
+
+// Energia: transições de estado do rádio de cada end device, integradas
+// no fim da execução
+lpwan::RadioEnergyLog radioEnergy;
+double initialEnergy = 3600.0; // Joules, bateria de cada end device
+uint8_t txLevel = 0;           // nível de TX do perfil para 14 dBm
+
+// Tempo por fase, eventos e memória de cada replicação (--profile)
+lpwan::Profiler profiler;
 
 // Função para reiniciar as métricas entre execuções
-void ResetMetrics() {
-    packetsSent = 0;
-    packetsReceived = 0;
-    duplicatedPackets = 0;
-    totalBytesReceived = 0.0;
-    totalTransmitTime = 0.0;
-    totalDelay = Seconds(0);
-    receivedUids.clear();
-    sentTimes.clear();
-    totalEnergyConsumption = 0.0;
+void ResetMetrics(uint32_t deviceCount, double simTime) {
+    metrics.Reset(deviceCount);
+    uidTracker.Reset(deviceCount, simTime);
+    interference.Reset();
+    losses = lpwan::LossBreakdown{};
+    radioEnergy.Reset(lpwan::LoraRadioProfile(), deviceCount);
+    txLevel = radioEnergy.GetProfile().TxLevel(14.0);
+}
+
+// Estado do PHY do end device (SLEEP/STANDBY/TX/RX): só registra a transição
+void RadioStateChanged(uint32_t dev, EndDeviceLoraPhy::State, EndDeviceLoraPhy::State state) {
+    static const uint8_t map[] = {lpwan::RADIO_SLEEP, lpwan::RADIO_IDLE, lpwan::RADIO_TX, lpwan::RADIO_RX};
+    radioEnergy.SetState(dev, Simulator::Now().GetSeconds(), map[state], txLevel);
+}
+
+void LostBecauseInterference(Ptr<const Packet>, uint32_t) {
+    losses.interference++;
+}
+
+void LostBecauseUnderSensitivity(Ptr<const Packet>, uint32_t) {
+    losses.underSensitivity++;
+}
+
+void LostBecauseGatewayBusy(Ptr<const Packet>, uint32_t) {
+    losses.gatewayBusy++;
 }
 
 // Funções de callback
 void PacketSent(Ptr<LoraNetDevice> device, Ptr<Packet> packet) {
-    uint32_t uid = packet->GetUid();
-    packetsSent++;
-    sentTimes[uid] = Simulator::Now();
-    totalTransmitTime += 1.0;
-    
-    // Consumo de energia por transmissão (simplificado)
-    totalEnergyConsumption += 0.1; // 0.1 J por transmissão
-    
+    uint32_t dev = device->GetNode()->GetId() - firstDeviceId;
+    metrics.RecordTx(dev);
+    uidTracker.RecordSend(packet->GetUid(), dev, Simulator::Now().GetSeconds());
     device->Send(packet);
 }
 
 bool PacketReceived(Ptr<NetDevice> dev, Ptr<const Packet> packet, uint16_t, const Address&) {
-    uint32_t uid = packet->GetUid();
-    uint32_t packetSize = packet->GetSize();
+    lpwan::UidTracker::Reception rx = uidTracker.RecordReceive(packet->GetUid(), Simulator::Now().GetSeconds());
 
-    if (receivedUids.find(uid) != receivedUids.end()) {
-        duplicatedPackets++;
+    if (rx.status == lpwan::UidTracker::DUPLICATE) {
+        if (rx.dev != lpwan::UidTracker::NO_DEVICE) {
+            metrics.RecordDuplicate(rx.dev);
+        }
         return false;
     }
+    if (rx.status == lpwan::UidTracker::UNKNOWN) {
+        return true; // Pacote que não partiu de um end device desta execução
+    }
+
+    metrics.RecordRx(rx.dev, packet->GetSize(), Simulator::Now().GetSeconds() - rx.sendTime);
+    return true;
+}
 
-    receivedUids.insert(uid);
-    packetsReceived++;
-    totalBytesReceived += packetSize;
+// Deduplicação do servidor de rede: a primeira cópia de um uplink (por UID)
+// vale para as métricas; as cópias entregues por outros gateways são
+// redundantes, não retransmissões
+bool GatewayReceived(Ptr<NetDevice> dev, Ptr<const Packet> packet, uint16_t, const Address&) {
+    uint32_t gw = dev->GetNode()->GetId() - firstGatewayId;
+    lpwan::UidTracker::Reception rx = uidTracker.RecordReceive(packet->GetUid(), Simulator::Now().GetSeconds());
 
-    if (sentTimes.find(uid) != sentTimes.end()) {
-        Time delay = Simulator::Now() - sentTimes[uid];
-        totalDelay += delay;
-        sentTimes.erase(uid);
+    if (rx.status == lpwan::UidTracker::DUPLICATE) {
+        gatewayRedundant[gw]++;
+        return true;
+    }
+    if (rx.status == lpwan::UidTracker::UNKNOWN) {
+        return true;
     }
 
+    gatewayUnique[gw]++;
+    metrics.RecordRx(rx.dev, packet->GetSize(), Simulator::Now().GetSeconds() - rx.sendTime);
     return true;
 }
 
-int main(int argc, char* argv[]) {
-    LogComponentEnable("SimpleLorawanNetworkExample", LOG_LEVEL_INFO);
+// Parâmetros do cenário (iguais para todas as execuções)
+struct LorawanScenario {
+    double distance;
+    uint32_t deviceCount;
+    uint32_t payloadSize;
+    double simTime;               // s
+    lpwan::TrafficConfig traffic; // padrão single: um envio por dispositivo em 1 + k s
+    std::string trafficName;
+    uint32_t gatewayCount;        // usado sem gatewayLayout
+    double gatewaySpacing;        // m, lado da grade de gateways
+    std::string gatewayLayout;    // arquivo com uma posição "x y [z]" por linha
+    lpwan::Placement gatewayPositions;
+    lpwan::PlacementConfig placement; // layout dos dispositivos (raio = distance)
+    bool sfFromTable;                 // SF de cada dispositivo = menor SF que fecha o enlace
+};
+
+// Recepções no servidor de rede (agregadas; o detalhe por gateway vai para CSV)
+struct GatewayStats {
+    uint32_t gateways;
+    double meanReach;   // gateways ao alcance por dispositivo
+    uint64_t unique;
+    uint64_t redundant;
+};
+
+// Resultado de uma replicação: bloco padronizado + perdas por causa
+struct LorawanRunResult {
+    lpwan::RunResult result;
+    lpwan::LossBreakdown losses;
+    GatewayStats gateways;
+    double batteryLifeDays; // do dispositivo que mais consome, no ritmo da execução
+    uint64_t expired;       // enviados que saíram do anel de UIDs sem recepção
+    lpwan::RunProfile profile;
+    lpwan::LatencyReport latency; // geral e por SF
+};
+
+// Hash dos parâmetros que mudam o resultado. Tráfego, duração e layout só
+// entram quando diferem do cenário original, para manter o hash dos shards já
+// gravados.
+lpwan::ConfigHash ScenarioHash(const LorawanScenario& scenario) {
+    lpwan::ConfigHash hash;
+    hash.Add("distance", scenario.distance)
+        .Add("deviceCount", scenario.deviceCount)
+        .Add("payloadSize", scenario.payloadSize);
+    if (scenario.traffic.pattern != lpwan::TRAFFIC_SINGLE || scenario.simTime != 15.0) {
+        hash.Add("simTime", scenario.simTime)
+            .Add("traffic", scenario.trafficName)
+            .Add("period", scenario.traffic.period)
+            .Add("jitter", scenario.traffic.jitter)
+            .Add("maxPackets", scenario.traffic.maxPackets);
+    }
+    if (scenario.gatewayPositions.size() != 1) {
+        for (uint32_t g = 0; g < scenario.gatewayPositions.size(); ++g) {
+            hash.Add("gw", scenario.gatewayPositions.x[g])
+                .Add("gw", scenario.gatewayPositions.y[g])
+                .Add("gw", scenario.gatewayPositions.z[g]);
+        }
+    }
+    if (!scenario.placement.IsDefault("annulus")) {
+        hash.Add("layout", scenario.placement.Describe());
+    }
+    if (scenario.sfFromTable) {
+        hash.Add("sfFromTable", 1);
+    }
+    return hash;
+}
 
-    double distance = 1000.0;  // Distância padrão
-    uint32_t deviceCount = 10;  // Número padrão de dispositivos
-    uint32_t payloadSize = 50;  // Payload padrão
-    uint32_t runSeed = 12345;  // Seed padrão
-    uint32_t numExecutions = 1;  // Uma execução por padrão
+// Topologia de um cenário: nós, dispositivos, canal e traces. Nada aqui
+// depende da execução; posições, SF, fluxos do RNG e tráfego ficam em
+// RunOnTopology, então a mesma topologia serve a várias replicações
+// (--reuseTopology)
+struct LorawanTopology {
+    Ptr<PropagationDelayModel> delay;
+    Ptr<lpwan::TrackedLoraChannel> channel;
+    NodeContainer endDevices;
+    NodeContainer gateways;
+    NetDeviceContainer endDeviceNetDevices;
+    NetDeviceContainer gatewayNetDevices;
+    std::vector<Ptr<LoraPhy>> endDevicePhys;
+};
+
+LorawanTopology BuildTopology(const LorawanScenario& scenario) {
+    profiler.Begin(lpwan::PHASE_BUILD);
+    LorawanTopology topology;
+
+    // Configuração do canal e dispositivos
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetPathLossExponent(4.00);
+    loss->SetReference(1, 10);
+
+    topology.delay = CreateObject<RandomPropagationDelayModel>();
+    topology.channel = CreateObject<lpwan::TrackedLoraChannel>(loss, topology.delay);
+    topology.channel->SetTracker(&interference);
+
+    LogicalLoraChannelHelper logicalChannelHelper;
+    logicalChannelHelper.AddSubBand(915000000, 928000000, 0.01, 30);
+
+    LoraPhyHelper phyHelper;
+    phyHelper.SetChannel(topology.channel);
+
+    LorawanMacHelper macHelper;
+    LoraHelper helper;
+
+    // Posições provisórias: cada replicação instala as suas
+    topology.endDevices.Create(scenario.deviceCount);
+    lpwan::Placement origin;
+    origin.resize(scenario.deviceCount);
+    lpwan::InstallPlacement(topology.endDevices, origin);
+
+    profiler.Begin(lpwan::PHASE_INSTALL);
+    phyHelper.SetDeviceType(LoraPhyHelper::ED);
+    macHelper.SetDeviceType(LorawanMacHelper::ED_A);
+    topology.endDeviceNetDevices = helper.Install(phyHelper, macHelper, topology.endDevices);
+    firstDeviceId = topology.endDevices.Get(0)->GetId();
+
+    topology.gateways.Create(scenario.gatewayPositions.size());
+    lpwan::InstallPlacement(topology.gateways, scenario.gatewayPositions);
+    firstGatewayId = topology.gateways.Get(0)->GetId();
+
+    phyHelper.SetDeviceType(LoraPhyHelper::GW);
+    macHelper.SetDeviceType(LorawanMacHelper::GW);
+    topology.gatewayNetDevices = helper.Install(phyHelper, macHelper, topology.gateways);
+
+    // Conectar callbacks para dispositivos
+    for (uint32_t i = 0; i < topology.endDeviceNetDevices.GetN(); ++i) {
+        Ptr<LoraNetDevice> dev = DynamicCast<LoraNetDevice>(topology.endDeviceNetDevices.Get(i));
+        dev->SetReceiveCallback(MakeCallback(&PacketReceived));
+        topology.endDevicePhys.push_back(dev->GetPhy());
+        dev->GetPhy()->TraceConnectWithoutContext("EndDeviceState", MakeBoundCallback(&RadioStateChanged, i));
+    }
 
-    CommandLine cmd;
-    cmd.AddValue("distance", "Distância entre dispositivos e gateway (m)", distance);
-    cmd.AddValue("deviceCount", "Número de dispositivos", deviceCount);
-    cmd.AddValue("payloadSize", "Tamanho do payload (bytes)", payloadSize);
-    cmd.AddValue("runSeed", "Seed para reprodutibilidade", runSeed);
-    cmd.AddValue("numExecutions", "Número de execuções", numExecutions);
-    cmd.Parse(argc, argv);
+    // Conectar callbacks para gateways
+    for (uint32_t j = 0; j < topology.gatewayNetDevices.GetN(); ++j) {
+        Ptr<LoraNetDevice> gatewayDev = DynamicCast<LoraNetDevice>(topology.gatewayNetDevices.Get(j));
+        gatewayDev->SetReceiveCallback(MakeCallback(&GatewayReceived));
+
+        Ptr<LoraPhy> gatewayPhy = gatewayDev->GetPhy();
+        topology.channel->AddGateway(gatewayPhy);
+        gatewayPhy->TraceConnectWithoutContext("LostPacketBecauseInterference",
+                                               MakeCallback(&LostBecauseInterference));
+        gatewayPhy->TraceConnectWithoutContext("LostPacketBecauseUnderSensitivity",
+                                               MakeCallback(&LostBecauseUnderSensitivity));
+        gatewayPhy->TraceConnectWithoutContext("LostPacketBecauseNoMoreReceivers",
+                                               MakeCallback(&LostBecauseGatewayBusy));
+        gatewayPhy->TraceConnectWithoutContext("NoReceptionBecauseTransmitting",
+                                               MakeCallback(&LostBecauseGatewayBusy));
+    }
+    profiler.End();
+    return topology;
+}
 
-    RngSeedManager::SetSeed(runSeed);
+// Executa uma replicação sobre a topologia montada e devolve as métricas
+// finais. Toda variável aleatória da execução tem fluxo fixo do RNG,
+// recriado com a execução atual: o atraso de propagação (fluxo 0), os MACs
+// dos end devices e o gerador de tráfego, nessa ordem. As posições vêm de
+// PlacementSeed e o resto da topologia (perda, PHYs, MACs dos gateways) não
+// sorteia nada; assim, com topologia nova ou herdada de um fork, o resultado
+// é o mesmo. Um objeto aleatório novo precisa entrar nessa sequência.
+LorawanRunResult RunOnTopology(const LorawanScenario& scenario, LorawanTopology& topology, uint32_t runNumber) {
+    NS_LOG_INFO("Execução " << runNumber);
+
+    profiler.Begin(lpwan::PHASE_INSTALL);
+    ResetMetrics(scenario.deviceCount, scenario.simTime);
+    RngSeedManager::SetRun(runNumber);  // Define um número único para cada execução
+    int64_t stream = topology.delay->AssignStreams(0);
+    LorawanMacHelper macHelper;
+    stream += macHelper.AssignStreams(topology.endDeviceNetDevices, stream);
+
+    double distance = scenario.distance;
+    uint32_t deviceCount = scenario.deviceCount;
+    uint32_t payloadSize = scenario.payloadSize;
+    Ptr<lpwan::TrackedLoraChannel> channel = topology.channel;
+    const NodeContainer& gateways = topology.gateways;
+    const NetDeviceContainer& endDeviceNetDevices = topology.endDeviceNetDevices;
+
+    lpwan::PlacementConfig placement = scenario.placement;
+    placement.count = deviceCount;
+    placement.seed = lpwan::PlacementSeed(RngSeedManager::GetSeed(), runNumber);
+    lpwan::Placement devicePositions = lpwan::GeneratePlacement(placement);
+    lpwan::InstallPlacement(topology.endDevices, devicePositions);
+
+    // Orçamento de enlace de todos os pares (dispositivo, gateway), uma vez:
+    // mesmo modelo log-distância do canal, 14 dBm (padrão do end device)
+    lpwan::LinkBudgetParams budget;
+    budget.txPowerDbm = 14.0;
+    budget.pathLossExponent = 4.0;
+    budget.referenceDistance = 1.0;
+    budget.referenceLossDb = 10.0;
+    lpwan::LinkBudgetTable linkBudget;
+    linkBudget.Build(budget, devicePositions.x.data(), devicePositions.y.data(), devicePositions.z.data(), deviceCount,
+                     scenario.gatewayPositions.x.data(), scenario.gatewayPositions.y.data(),
+                     scenario.gatewayPositions.z.data(), scenario.gatewayPositions.size());
+    gatewayUnique.assign(gateways.GetN(), 0);
+    gatewayRedundant.assign(gateways.GetN(), 0);
+
+    if (scenario.sfFromTable) {
+        for (uint32_t i = 0; i < endDeviceNetDevices.GetN(); ++i) {
+            if (linkBudget.MinSf(i) != 0) {
+                // DR = 12 - SF (EU868 / 125 kHz)
+                Ptr<LoraNetDevice> dev = DynamicCast<LoraNetDevice>(endDeviceNetDevices.Get(i));
+                DynamicCast<EndDeviceLorawanMac>(dev->GetMac())->SetDataRate(12 - linkBudget.MinSf(i));
+            }
+        }
+    }
+    channel->SetLinkBudget(linkBudget, topology.endDevicePhys, budget.txPowerDbm);
+
+    // Classe do histograma de atraso = SF de cada dispositivo (DR = 12 - SF)
+    metrics.SetLatencyClasses({"SF7", "SF8", "SF9", "SF10", "SF11", "SF12"});
+    for (uint32_t i = 0; i < endDeviceNetDevices.GetN(); ++i) {
+        Ptr<LoraNetDevice> dev = DynamicCast<LoraNetDevice>(endDeviceNetDevices.Get(i));
+        uint8_t dataRate = DynamicCast<EndDeviceLorawanMac>(dev->GetMac())->GetDataRate();
+        metrics.SetClass(i, 5 - std::min<uint8_t>(dataRate, 5));
+    }
 
-    for (uint32_t run = 0; run < numExecutions; run++) {
-        NS_LOG_INFO("Execução " << run + 1);
+    // Enviar pacotes: um evento pendente por dispositivo; o pacote só é
+    // criado no instante do envio
+    lpwan::TrafficConfig trafficConfig = scenario.traffic;
+    trafficConfig.stop = scenario.simTime;
+    lpwan::TrafficGenerator traffic;
+    traffic.AssignStreams(stream);
+    traffic.Install(deviceCount, trafficConfig, [&endDeviceNetDevices, payloadSize](uint32_t k) {
+        Ptr<LoraNetDevice> dev = DynamicCast<LoraNetDevice>(endDeviceNetDevices.Get(k));
+        PacketSent(dev, Create<Packet>(payloadSize));
+    });
+
+    Simulator::Stop(Seconds(scenario.simTime));
+    profiler.Begin(lpwan::PHASE_RUN);
+    Simulator::Run();
+    profiler.End();
+    interference.Finish();
+    double maxDeviceEnergy = 0.0;
+    for (uint32_t i = 0; i < deviceCount; ++i) {
+        double joules = radioEnergy.Energy(i, scenario.simTime);
+        metrics.AddEnergy(i, joules);
+        maxDeviceEnergy = std::max(maxDeviceEnergy, joules);
+    }
+
+    // Cálculo das métricas finais
+    lpwan::MetricsTotals totals = metrics.Aggregate();
+    uint64_t packetsSent = totals.tx;
+    uint64_t packetsReceived = totals.rx;
+    uint64_t duplicatedPackets = totals.duplicates;
+    double totalTransmitTime = totals.tx * 1.0; // 1 s de canal por transmissão
+
+    lpwan::RunResult result;
+    result.run = runNumber;
+    result.devices = deviceCount;
+    result.distance = distance;
+    result.packetsSent = packetsSent;
+    result.packetsReceived = packetsReceived;
+    result.packetsDuplicated = duplicatedPackets;
+    result.pdr = (packetsSent > 0) ? (double(packetsReceived) / packetsSent) * 100 : 0.0;
+    result.plr = (packetsSent > 0) ? (double(packetsSent - packetsReceived) / packetsSent) * 100 : 0.0;
+    result.throughput = totals.bytesReceived * 8 / scenario.simTime; // bps
+    result.retransmissionRate = (packetsReceived > 0) ? (double(duplicatedPackets) / packetsReceived) * 100 : 0.0;
+    result.channelUtilization = (packetsSent > 0) ?
+        (totalTransmitTime / scenario.simTime) * 100 : 0.0;
+    result.averageDelay = (packetsReceived > 0) ? (totals.delaySum / packetsReceived) : 0.0;
+    lpwan::FillDelayPercentiles(result, metrics.GetLatency().all);
+    result.bandwidthUsed = 125.0; // LoRaWAN usa 125 kHz
+    result.energyConsumption = totals.energy;
+
+    LorawanRunResult out;
+    out.result = result;
+    out.losses = losses;
+    interference.AddTo(out.losses);
+    channel->AddTo(out.losses);
+    out.gateways.gateways = gateways.GetN();
+    out.gateways.meanReach = channel->GetMeanReach();
+    out.latency = metrics.GetLatency();
+    out.expired = uidTracker.GetExpired();
+    out.batteryLifeDays = maxDeviceEnergy > 0.0 ? initialEnergy / (maxDeviceEnergy / scenario.simTime) / 86400.0 : 0.0;
+    out.gateways.unique = 0;
+    out.gateways.redundant = 0;
+    for (uint32_t g = 0; g < gateways.GetN(); ++g) {
+        out.gateways.unique += gatewayUnique[g];
+        out.gateways.redundant += gatewayRedundant[g];
+    }
+
+    // Detalhe por gateway (só com mais de um): um arquivo por execução
+    if (gateways.GetN() > 1) {
+        std::ostringstream name;
+        name << "gateways_lorawan_" << std::hex << std::setw(16) << std::setfill('0')
+             << ScenarioHash(scenario).Get() << std::dec << "_s" << RngSeedManager::GetSeed() << "_r" << runNumber
+             << ".csv";
+        std::ofstream gatewayFile(name.str());
+        gatewayFile << "Gateway,X (m),Y (m),Recepções Únicas,Recepções Redundantes\n";
+        for (uint32_t g = 0; g < gateways.GetN(); ++g) {
+            gatewayFile << g << "," << scenario.gatewayPositions.x[g] << "," << scenario.gatewayPositions.y[g] << "," << gatewayUnique[g] << "," << gatewayRedundant[g]
+                        << "\n";
+        }
+    }
+
+    profiler.Begin(lpwan::PHASE_TEARDOWN);
+    Simulator::Destroy();
+    out.profile = profiler.Finish();
+    return out;
+}
+
+// Replicação a frio: monta a topologia da execução e roda
+LorawanRunResult RunReplication(const LorawanScenario& scenario, uint32_t runNumber) {
+    RngSeedManager::SetRun(runNumber);
+    LorawanTopology topology = BuildTopology(scenario);
+    return RunOnTopology(scenario, topology, runNumber);
+}
 
-        ResetMetrics();
-        RngSeedManager::SetRun(run + 1);  // Define um número único para cada execução
+// Replicações do cenário. Com reuseTopology a topologia é montada uma vez
+// neste processo e cada replicação roda num filho (fork, cópia sob escrita)
+// que só refaz o que depende da execução
+std::vector<LorawanRunResult> ReplicateScenario(const LorawanScenario& scenario, const std::vector<uint32_t>& runs,
+                                                uint32_t jobs, bool reuseTopology) {
+    if (!reuseTopology) {
+        return lpwan::RunReplications<LorawanRunResult>(
+            runs, jobs, [&scenario](uint32_t runNumber) { return RunReplication(scenario, runNumber); });
+    }
+    RngSeedManager::SetRun(runs.front());
+    LorawanTopology topology = BuildTopology(scenario);
+    std::vector<LorawanRunResult> results = lpwan::ForkReplications<LorawanRunResult>(
+        runs, jobs, [&scenario, &topology](uint32_t runNumber) { return RunOnTopology(scenario, topology, runNumber); });
+    Simulator::Destroy();
+    return results;
+}
+
+// Replicações em rodadas até a semiamplitude relativa do IC de todas as
+// métricas escolhidas ficar abaixo do alvo (lpwan-stopping.h). A numeração
+// das execuções continua entre rodadas; com --reuseTopology cada rodada monta
+// a topologia de novo.
+std::vector<LorawanRunResult> ReplicateUntilConverged(const LorawanScenario& scenario,
+                                                      const lpwan::SequentialStopping& stopping,
+                                                      const std::vector<lpwan::StoppingMetric>& metrics,
+                                                      uint32_t firstRun, uint32_t jobs, bool reuseTopology) {
+    std::vector<LorawanRunResult> results;
+    std::vector<std::vector<double>> samples(metrics.size());
+    uint32_t next = firstRun;
+    for (uint32_t more = stopping.More(samples, jobs); more > 0; more = stopping.More(samples, jobs)) {
+        std::vector<uint32_t> runs;
+        for (uint32_t i = 0; i < more; ++i) {
+            runs.push_back(next++);
+        }
+        for (const LorawanRunResult& run : ReplicateScenario(scenario, runs, jobs, reuseTopology)) {
+            results.push_back(run);
+            for (size_t m = 0; m < metrics.size(); ++m) {
+                samples[m].push_back(run.result.*(metrics[m].field));
+            }
+        }
+        std::cout << "IC após " << results.size() << " execuções: ±" << lpwan::SequentialStopping::Worst(samples) * 100
+                  << " % (alvo ±" << stopping.target * 100 << " %)" << std::endl;
+    }
+    return results;
+}
 
-        // Configuração do canal e dispositivos
-        Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
-        loss->SetPathLossExponent(4.00);
-        loss->SetReference(1, 10);
+// Modo analítico: mesmo registro do caminho DES, sem simular eventos
+int RunAnalytic(const LorawanScenario& scenario, uint32_t runSeed, uint32_t firstRun) {
+    lpwan::LorawanAnalyticParams params =
+        lpwan::DefaultLorawanAnalyticParams(scenario.distance, scenario.deviceCount, scenario.payloadSize);
+    params.simTime = scenario.simTime;
+    lpwan::RunResult result = lpwan::EvaluateLorawanAnalytic(params, firstRun);
+
+    uint32_t sf = lpwan::MinimumSf(params);
+    std::cout << "Modo analítico: SF" << sf << ", tempo no ar "
+              << (sf ? lpwan::LoraTimeOnAir(sf, scenario.payloadSize + params.macOverhead) : 0.0) << " s" << std::endl;
+    lpwan::PrintRunResult(std::cout, "LORAWAN", result);
+
+    uint64_t configHash = ScenarioHash(scenario).Add("mode", "analytic").Get();
+    lpwan::ResultSink sink("resultados_lorawan", lpwan::TECH_LORAWAN, "lorawan-test/analytic", runSeed, configHash,
+                           params.simTime);
+    sink.Add(result);
+    sink.Flush();
+    return 0;
+}
 
-        Ptr<PropagationDelayModel> delay = CreateObject<RandomPropagationDelayModel>();
-        Ptr<LoraChannel> channel = CreateObject<LoraChannel>(loss, delay);
+// Relatório de validação: DES (média ± IC 95%) contra o modelo analítico
+// para cada quantidade de dispositivos em `deviceCounts`
+int RunValidation(LorawanScenario scenario, const std::vector<uint32_t>& deviceCounts,
+                  const std::vector<uint32_t>& runs, uint32_t jobs, bool reuseTopology) {
+    std::ostringstream name;
+    name << "validacao_lorawan_" << scenario.distance << "m.csv";
+    std::ofstream csvFile(name.str());
+    csvFile << "Dispositivos,Métrica,DES Média,DES IC95,Analítico,Erro Relativo (%),Dentro do IC\n";
+
+    std::cout << "=== VALIDAÇÃO ANALÍTICO x DES (" << scenario.distance << " m, " << runs.size()
+              << " execuções por ponto) ===" << std::endl;
+    for (uint32_t n : deviceCounts) {
+        scenario.deviceCount = n;
+        std::vector<LorawanRunResult> results = ReplicateScenario(scenario, runs, jobs, reuseTopology);
+        lpwan::LorawanAnalyticParams params =
+            lpwan::DefaultLorawanAnalyticParams(scenario.distance, n, scenario.payloadSize);
+        params.simTime = scenario.simTime;
+        lpwan::RunResult analytic = lpwan::EvaluateLorawanAnalytic(params, runs.front());
+
+        struct Metric {
+            const char* name;
+            double lpwan::RunResult::*field;
+        };
+        static const Metric metricsList[] = {{"PDR (%)", &lpwan::RunResult::pdr},
+                                             {"Vazão (bps)", &lpwan::RunResult::throughput},
+                                             {"Atraso Médio (s)", &lpwan::RunResult::averageDelay},
+                                             {"Consumo Energia (J)", &lpwan::RunResult::energyConsumption}};
+        std::cout << "Dispositivos: " << n << std::endl;
+        for (const Metric& m : metricsList) {
+            std::vector<double> values;
+            for (const LorawanRunResult& r : results) {
+                values.push_back(r.result.*(m.field));
+            }
+            lpwan::MetricSummary des = lpwan::Summarize(values);
+            double model = analytic.*(m.field);
+            double error = des.mean != 0.0 ? (model - des.mean) / des.mean * 100 : 0.0;
+            bool inside = std::abs(model - des.mean) <= des.halfWidth;
+            std::cout << "  " << m.name << ": DES " << des.mean << " ± " << des.halfWidth << " | analítico " << model
+                      << " | erro " << error << " %" << (inside ? " (dentro do IC)" : "") << std::endl;
+            csvFile << n << "," << m.name << "," << des.mean << "," << des.halfWidth << "," << model << "," << error
+                    << "," << (inside ? 1 : 0) << "\n";
+        }
+    }
+    csvFile.close();
+    std::cout << "Relatório: " << name.str() << std::endl;
+    return 0;
+}
 
-        MobilityHelper mobility;
-        Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator>();
-        allocator->Add(Vector(0, 0, 0)); // Gateway
-        allocator->Add(Vector(distance, 0, 0)); // Dispositivos
-        mobility.SetPositionAllocator(allocator);
-        mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+int main(int argc, char* argv[]) {
+    LogComponentEnable("SimpleLorawanNetworkExample", LOG_LEVEL_INFO);
 
-        LogicalLoraChannelHelper logicalChannelHelper;
-        logicalChannelHelper.AddSubBand(915000000, 928000000, 0.01, 30);
+    LorawanScenario scenario;
+    scenario.distance = 1000.0;  // Distância padrão
+    scenario.deviceCount = 10;  // Número padrão de dispositivos
+    scenario.payloadSize = 50;  // Payload padrão
+    scenario.simTime = 15.0;  // Duração da simulação (s)
+    scenario.trafficName = "single";
+    scenario.gatewayCount = 1;
+    scenario.gatewaySpacing = 2000.0;
+    scenario.sfFromTable = false;
+    uint32_t runSeed = 12345;  // Seed padrão
+    uint32_t numExecutions = 1;  // Uma execução por padrão
+    uint32_t firstRun = 1;  // Número da primeira execução (stream do RNG)
+    uint32_t jobs = 1;  // Replicações simultâneas (processos)
+    bool reuseTopology = false;  // Monta a topologia uma vez e faz fork por replicação
+    bool profile = false;  // Tempo por fase, eventos e memória no bloco de resultados e no CSV
+    std::string mode = "des";  // des | analytic | validate
+    std::string validateDevices = "1,2,5,10,15,20";  // Pontos do relatório de validação
+    lpwan::SequentialStopping stopping;  // ciTarget > 0: número de execuções pelo IC
+    std::string ciMetrics = "pdr,delay,energy";  // Métricas do critério de parada
 
-        LoraPhyHelper phyHelper;
-        phyHelper.SetChannel(channel);
+    CommandLine cmd;
+    cmd.AddValue("distance", "Distância entre dispositivos e gateway (m)", scenario.distance);
+    cmd.AddValue("deviceCount", "Número de dispositivos", scenario.deviceCount);
+    cmd.AddValue("payloadSize", "Tamanho do payload (bytes)", scenario.payloadSize);
+    cmd.AddValue("runSeed", "Seed para reprodutibilidade", runSeed);
+    cmd.AddValue("numExecutions", "Número de execuções", numExecutions);
+    cmd.AddValue("firstRun", "Número da primeira execução (usado pela varredura)", firstRun);
+    cmd.AddValue("jobs", "Replicações simultâneas em processos isolados", jobs);
+    cmd.AddValue("reuseTopology", "Monta a topologia uma vez e roda cada replicação num fork dela", reuseTopology);
+    cmd.AddValue("simTime", "Duração da simulação (s)", scenario.simTime);
+    cmd.AddValue("traffic", "Padrão de tráfego: single, periodic, poisson ou jittered", scenario.trafficName);
+    cmd.AddValue("period", "Intervalo (médio) entre mensagens de um dispositivo (s)", scenario.traffic.period);
+    cmd.AddValue("jitter", "Variação do período no padrão jittered (fração)", scenario.traffic.jitter);
+    cmd.AddValue("maxPackets", "Mensagens por dispositivo (0 = até o fim da simulação)", scenario.traffic.maxPackets);
+    cmd.AddValue("gatewayCount", "Número de gateways (grade quadrada)", scenario.gatewayCount);
+    cmd.AddValue("gatewaySpacing", "Distância entre gateways vizinhos na grade (m)", scenario.gatewaySpacing);
+    cmd.AddValue("gatewayLayout", "Arquivo com as posições dos gateways (x y [z] por linha)", scenario.gatewayLayout);
+    cmd.AddValue("layout", "Posição dos dispositivos: annulus, disc, grid, hex, line ou file", scenario.placement.layout);
+    cmd.AddValue("layoutWidth", "Largura do anel no layout annulus (m)", scenario.placement.width);
+    cmd.AddValue("layoutSpacing", "Espaçamento dos layouts grid, hex e line (m)", scenario.placement.spacing);
+    cmd.AddValue("layoutFile", "Arquivo de posições do layout file (CSV/texto ou .bin)", scenario.placement.file);
+    cmd.AddValue("sfFromTable", "Usa em cada dispositivo o menor SF que fecha o enlace", scenario.sfFromTable);
+    cmd.AddValue("mode", "Caminho de cálculo: des, analytic ou validate", mode);
+    cmd.AddValue("profile", "Tempo por fase, eventos/s, pico de memória e alocações por evento", profile);
+    cmd.AddValue("validateDevices", "Quantidades de dispositivos validadas (--mode=validate)", validateDevices);
+    cmd.AddValue("ciTarget", "Semiamplitude relativa do IC 95% que encerra as replicações (0 = numExecutions fixo)",
+                 stopping.target);
+    cmd.AddValue("minExecutions", "Mínimo de execuções com --ciTarget", stopping.minRuns);
+    cmd.AddValue("maxExecutions", "Máximo de execuções com --ciTarget", stopping.maxRuns);
+    cmd.AddValue("ciMetrics", "Métricas do critério de parada: pdr, delay, energy, throughput, p99", ciMetrics);
+    cmd.Parse(argc, argv);
 
-        LorawanMacHelper macHelper;
-        LoraHelper helper;
+    std::vector<lpwan::StoppingMetric> stoppingMetrics;
+    try {
+        scenario.traffic.pattern = lpwan::ParseTrafficPattern(scenario.trafficName);
+        lpwan::ValidateTrafficConfig(scenario.traffic);
+        stoppingMetrics = lpwan::ParseStoppingMetrics(ciMetrics);
+        lpwan::PlacementConfig gatewayGrid;
+        gatewayGrid.layout = "grid";
+        gatewayGrid.count = std::max<uint32_t>(scenario.gatewayCount, 1);
+        gatewayGrid.spacing = scenario.gatewaySpacing;
+        scenario.gatewayPositions = scenario.gatewayLayout.empty() ? lpwan::GeneratePlacement(gatewayGrid)
+                                                                   : lpwan::ReadPlacementFile(scenario.gatewayLayout);
+        scenario.placement.radius = scenario.distance;
+        lpwan::GeneratePlacement(scenario.placement); // valida o layout (count ainda é 0)
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (mode != "des" && (scenario.traffic.pattern != lpwan::TRAFFIC_SINGLE || scenario.gatewayPositions.size() != 1 ||
+                          scenario.placement.layout != "annulus" || scenario.placement.width != 0.0)) {
+        std::cerr << "O modelo analítico só cobre o tráfego single, um gateway e todos os dispositivos a "
+                     "--distance (layout annulus sem largura)"
+                  << std::endl;
+        return 1;
+    }
 
-        NodeContainer endDevices;
-        endDevices.Create(deviceCount);
-        mobility.Install(endDevices);
+    if (stopping.Enabled() && stopping.maxRuns < std::max<uint32_t>(stopping.minRuns, 2)) {
+        std::cerr << "--maxExecutions precisa ser pelo menos --minExecutions (e 2)" << std::endl;
+        return 1;
+    }
 
-        phyHelper.SetDeviceType(LoraPhyHelper::ED);
-        macHelper.SetDeviceType(LorawanMacHelper::ED_A);
-        NetDeviceContainer endDeviceNetDevices = helper.Install(phyHelper, macHelper, endDevices);
+    if (mode == "analytic") {
+        return RunAnalytic(scenario, runSeed, firstRun);
+    }
+    if (mode != "des" && mode != "validate") {
+        std::cerr << "Modo desconhecido: " << mode << " (use des, analytic ou validate)" << std::endl;
+        return 1;
+    }
 
-        NodeContainer gateways;
-        gateways.Create(1); // Apenas um gateway
-        mobility.Install(gateways);
+    RngSeedManager::SetSeed(runSeed);
+    profiler.Enable(profile);
 
-        phyHelper.SetDeviceType(LoraPhyHelper::GW);
-        macHelper.SetDeviceType(LorawanMacHelper::GW);
-        NetDeviceContainer gatewayNetDevices = helper.Install(phyHelper, macHelper, gateways);
+    std::vector<uint32_t> runs;
+    for (uint32_t run = 0; run < numExecutions; run++) {
+        runs.push_back(firstRun + run);
+    }
 
-        // Conectar callbacks para dispositivos
-        for (uint32_t i = 0; i < endDeviceNetDevices.GetN(); ++i) {
-            Ptr<LoraNetDevice> dev = DynamicCast<LoraNetDevice>(endDeviceNetDevices.Get(i));
-            dev->GetPhy()->TraceConnectWithoutContext("SendPacket", MakeCallback(&PacketSent));
-            dev->SetReceiveCallback(MakeCallback(&PacketReceived));
+    // Com jobs > 1 (ou --reuseTopology) cada replicação roda num processo
+    // filho com seu próprio RngSeedManager::SetRun; o processo pai só
+    // coleta e imprime. Com --ciTarget o número de execuções vem do IC.
+    // Falha de um worker (ou de pipe/fork/poll) chega aqui como exceção
+    std::vector<LorawanRunResult> results;
+    try {
+        if (mode == "validate") {
+            std::vector<uint32_t> deviceCounts;
+            std::stringstream list(validateDevices);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                if (!item.empty()) {
+                    deviceCounts.push_back(std::stoul(item));
+                }
+            }
+            return RunValidation(scenario, deviceCounts, runs, jobs, reuseTopology);
         }
+        results = stopping.Enabled()
+                      ? ReplicateUntilConverged(scenario, stopping, stoppingMetrics, firstRun, jobs, reuseTopology)
+                      : ReplicateScenario(scenario, runs, jobs, reuseTopology);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
 
-        // Conectar callbacks para gateways
-        for (uint32_t j = 0; j < gatewayNetDevices.GetN(); ++j) {
-            Ptr<LoraNetDevice> gatewayDev = DynamicCast<LoraNetDevice>(gatewayNetDevices.Get(j));
-            gatewayDev->SetReceiveCallback(MakeCallback(&PacketReceived));
-        }
+    uint64_t configHash = ScenarioHash(scenario).Get();
+    lpwan::ResultSink sink("resultados_lorawan", lpwan::TECH_LORAWAN, "lorawan-test", runSeed, configHash,
+                           scenario.simTime);
+    if (profile) {
+        sink.SetExtraColumns(lpwan::ProfileCsvHeader());
+    }
 
-        // Enviar pacotes
-        for (uint32_t k = 0; k < endDevices.GetN(); ++k) {
-            Ptr<LoraNetDevice> dev = DynamicCast<LoraNetDevice>(endDeviceNetDevices.Get(k));
-            Ptr<Packet> packet = Create<Packet>(payloadSize);
-            Simulator::Schedule(Seconds(1.0 + k), &PacketSent, dev, packet);
+    std::vector<double> pdrs, delays, throughputs, energies;
+    for (const LorawanRunResult& run : results) {
+        const lpwan::RunResult& result = run.result;
+        // Saída padronizada
+        lpwan::PrintRunResult(std::cout, "LORAWAN", result);
+        lpwan::PrintRunProfile(std::cout, run.profile);
+        lpwan::PrintLatencyReport(std::cout, run.latency);
+        lpwan::PrintLossBreakdown(std::cout, run.losses);
+        std::cout << "Gateways: " << run.gateways.gateways << std::endl;
+        std::cout << "Gateways ao Alcance (média): " << run.gateways.meanReach << std::endl;
+        std::cout << "Recepções Únicas: " << run.gateways.unique << std::endl;
+        std::cout << "Recepções Redundantes: " << run.gateways.redundant << std::endl;
+        std::cout << "Vida da Bateria (dias): " << run.batteryLifeDays << std::endl;
+        std::cout << "Pacotes Expirados: " << run.expired << std::endl;
+
+        // Um shard por execução: nada é truncado e jobs paralelos não colidem
+        if (profile) {
+            sink.Add(result, lpwan::ProfileCsvRow(run.profile));
+        } else {
+            sink.Add(result);
         }
+        sink.Flush();
 
-        Simulator::Stop(Seconds(15));
-        Simulator::Run();
+        pdrs.push_back(result.pdr);
+        delays.push_back(result.averageDelay);
+        throughputs.push_back(result.throughput);
+        energies.push_back(result.energyConsumption);
+    }
 
-        // Cálculo das métricas finais
-        double pdr = (packetsSent > 0) ? (double(packetsReceived) / packetsSent) * 100 : 0.0;
-        double plr = (packetsSent > 0) ? (double(packetsSent - packetsReceived) / packetsSent) * 100 : 0.0;
-        double throughput = totalBytesReceived * 8 / 15.0; // bps
-        double retransmissionRate = (packetsReceived > 0) ? (double(duplicatedPackets) / packetsReceived) * 100 : 0.0;
-        double channelUtilization = (packetsSent > 0) ? 
-            (totalTransmitTime / 15.0) * 100 : 0.0; // Duração fixa de 15s
-        double averageDelay = (packetsReceived > 0) ? (totalDelay.GetSeconds() / packetsReceived) : 0.0;
-        double bandwidthUsed = 125.0; // LoRaWAN usa 125 kHz
-        double energyConsumption = totalEnergyConsumption;
+    // Média e intervalo de confiança de 95% entre as replicações
+    if (results.size() > 1) {
+        lpwan::MetricSummary pdr = lpwan::Summarize(pdrs);
+        lpwan::MetricSummary delayStats = lpwan::Summarize(delays);
+        lpwan::MetricSummary throughput = lpwan::Summarize(throughputs);
+        lpwan::MetricSummary energy = lpwan::Summarize(energies);
+        std::cout << "=== RESUMO LORAWAN (" << results.size() << " execuções, IC 95%) ===" << std::endl;
+        std::cout << "PDR (%): " << pdr.mean << " ± " << pdr.halfWidth << std::endl;
+        std::cout << "Vazão (bps): " << throughput.mean << " ± " << throughput.halfWidth << std::endl;
+        std::cout << "Atraso Médio (s): " << delayStats.mean << " ± " << delayStats.halfWidth << std::endl;
+        std::cout << "Consumo Energia (J): " << energy.mean << " ± " << energy.halfWidth << std::endl;
+        if (stopping.Enabled()) {
+            std::vector<std::vector<double>> samples(stoppingMetrics.size());
+            for (const LorawanRunResult& run : results) {
+                for (size_t m = 0; m < stoppingMetrics.size(); ++m) {
+                    samples[m].push_back(run.result.*(stoppingMetrics[m].field));
+                }
+            }
+            std::cout << "Execuções Necessárias: " << results.size() << std::endl;
+            std::cout << "Semiamplitude Relativa (%): " << lpwan::SequentialStopping::Worst(samples) * 100
+                      << (stopping.Converged(samples) ? " (convergiu)" : " (limite de execuções)") << std::endl;
+        }
 
-        // Saída padronizada
-        std::cout << "=== RESULTADOS LORAWAN ===" << std::endl;
-        std::cout << "Execução: " << (run + 1) << std::endl;
-        std::cout << "Distância (m): " << distance << std::endl;
-        std::cout << "Dispositivos: " << deviceCount << std::endl;
-        std::cout << "Pacotes Enviados: " << packetsSent << std::endl;
-        std::cout << "Pacotes Recebidos: " << packetsReceived << std::endl;
-        std::cout << "Pacotes Duplicados: " << duplicatedPackets << std::endl;
-        std::cout << "PDR (%): " << pdr << std::endl;
-        std::cout << "PLR (%): " << plr << std::endl;
-        std::cout << "Retransmissão (%): " << retransmissionRate << std::endl;
-        std::cout << "Vazão (bps): " << throughput << std::endl;
-        std::cout << "Utilização do Canal (%): " << channelUtilization << std::endl;
-        std::cout << "Atraso Médio (s): " << averageDelay << std::endl;
-        std::cout << "Banda Utilizada (kHz): " << bandwidthUsed << std::endl;
-        std::cout << "Consumo Energia (J): " << energyConsumption << std::endl;
-
-        // Gerar arquivo CSV
-        std::ofstream csvFile("resultados_lorawan.csv");
-        csvFile << "Execução,Distância (m),Dispositivos,Pacotes Enviados,Pacotes Recebidos,Pacotes Duplicados,PDR (%),PLR (%),Retransmissão (%),Vazão (bps),Utilização do Canal (%),Atraso Médio (s),Banda Utilizada (kHz),Consumo Energia (J)\n";
-        csvFile << (run + 1) << "," << distance << "," << deviceCount << "," << packetsSent << "," << packetsReceived << "," << duplicatedPackets << "," 
-                << pdr << "," << plr << "," << retransmissionRate << "," << throughput << "," << channelUtilization << "," 
-                << averageDelay << "," << bandwidthUsed << "," << energyConsumption << "\n";
-        csvFile.close();
-
-        Simulator::Destroy();
+        // Histogramas somados: percentis da amostra inteira de pacotes
+        lpwan::LatencyReport latency = results.front().latency;
+        for (size_t i = 1; i < results.size(); ++i) {
+            latency.Merge(results[i].latency);
+        }
+        std::cout << "Atraso p50/p90/p99/máx (s): " << lpwan::FormatPercentiles(latency.all) << std::endl;
+        lpwan::PrintLatencyReport(std::cout, latency);
     }
 
     return 0;
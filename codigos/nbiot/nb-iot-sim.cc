@@ -14,47 +14,111 @@
 #include "ns3/point-to-point-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
 #include "ns3/energy-module.h"
+#include "../comum/lpwan-metrics.h"
+#include "../comum/lpwan-uid-tracker.h"
+#include "../comum/lpwan-run-result.h"
+#include "../comum/lpwan-result-sink.h"
+#include "../comum/lpwan-placement.h"
+#include "../comum/lpwan-radio-energy.h"
+#include "../comum/lpwan-nbiot-psm.h"
+#include "../comum/lpwan-nbiot-access.h"
+#include "../comum/lpwan-link-budget.h"
+#include "../comum/lpwan-traffic.h"
+#include "../comum/lpwan-replication.h"
+#include "../comum/lpwan-profile.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
-#include <set>
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("NbIotSim");
 
-// Variáveis globais de métricas
-uint32_t totalTx = 0;
-uint32_t totalRx = 0;
+// Métricas por UE (índice = posição do UE em ueNodes)
+lpwan::MetricsStore metrics;
+lpwan::UidTracker uidTracker;
 uint32_t totalRetx = 0;
-uint32_t totalDuplicated = 0;
-double totalDelay = 0.0;
-Time startTime;
-std::set<uint32_t> receivedPacketIds;
 
-// Variáveis de energia
-double totalEnergyConsumption = 0.0;
-double initialEnergy = 3600.0; // Joules
+// Energia: estado do rádio de cada UE, integrado no fim da execução. O UE
+// fica conectado (IDLE no perfil) até o temporizador de inatividade do RRC
+// vencer depois da última atividade; depois dorme ou, com --psm, segue
+// idle com eDRX, PSM e TAU periódico. Os estados entre duas atividades só
+// são registrados quando a próxima chega (nenhum evento extra).
+lpwan::RadioEnergyLog radioEnergy;
+lpwan::NbIotPowerSaving powerSaving;
+double initialEnergy = 3600.0;          // Joules, bateria de cada UE
+const double uplinkRate = 62.5e3;       // bps, Cat-NB1 multi-tone
+const double downlinkRate = 26.15e3;    // bps, Cat-NB1
+const double ueTxPower = 23.0;          // dBm, classe 3
 
-void TxTrace(Ptr<const Packet> p)
+// Tempo por fase, eventos e memória de cada replicação (--profile)
+lpwan::Profiler profiler;
+
+// Capacidade da célula no modelo lte: o LteEnbRrc do NS-3 dá a cada UE um
+// índice de configuração de SRS e aborta quando eles acabam (um por ms do
+// período). Com a maior periodicidade (320 ms) cabem 320 UEs; acima disso,
+// só o --model=reduced
+const uint32_t lteMaxUesPerCell = 320;
+
+// Rajada de TX ou RX de `bytes`; o UE volta a conectado
+void RadioActivity(uint32_t ue, uint8_t state, uint32_t bytes)
+{
+  double duration = bytes * 8 / (state == lpwan::RADIO_TX ? uplinkRate : downlinkRate);
+  powerSaving.Activity(ue, Simulator::Now().GetSeconds(), state, duration,
+                       radioEnergy.GetProfile().TxLevel(ueTxPower));
+}
+
+void TxTrace(uint32_t ue, Ptr<const Packet> p)
+{
+  metrics.RecordTx(ue);
+  uidTracker.RecordSend(p->GetUid(), ue, Simulator::Now().GetSeconds());
+  RadioActivity(ue, lpwan::RADIO_TX, p->GetSize());
+}
+
+// Resposta do eco chegando ao UE
+void UeRxTrace(uint32_t ue, Ptr<const Packet> p)
 {
-  totalTx++;
-  // Consumo de energia por transmissão (simplificado)
-  totalEnergyConsumption += 0.05; // 0.05 J por transmissão
+  RadioActivity(ue, lpwan::RADIO_RX, p->GetSize());
 }
 
-void RxTrace(Ptr<const Packet> p, const Address &addr)
+void RxTrace(Ptr<const Packet> p)
 {
-  uint32_t packetId = p->GetUid();
-  
-  if (receivedPacketIds.find(packetId) != receivedPacketIds.end()) {
-    totalDuplicated++;
+  lpwan::UidTracker::Reception rx = uidTracker.RecordReceive(p->GetUid(), Simulator::Now().GetSeconds());
+
+  if (rx.status == lpwan::UidTracker::DUPLICATE) {
+    if (rx.dev != lpwan::UidTracker::NO_DEVICE) {
+      metrics.RecordDuplicate(rx.dev);
+    }
     return;
   }
-  
-  receivedPacketIds.insert(packetId);
-  totalRx++;
-  totalDelay += Simulator::Now().GetSeconds() - startTime.GetSeconds();
+  if (rx.status == lpwan::UidTracker::UNKNOWN) {
+    return; // Não enviado nesta execução ou já expirado
+  }
+
+  metrics.RecordRx(rx.dev, p->GetSize(), Simulator::Now().GetSeconds() - rx.sendTime);
+}
+
+// Modo uplink: um único PacketSink no remote host recebe de todos os UEs;
+// o UE de cada pacote sai do endereço de origem
+std::unordered_map<uint32_t, uint32_t> ueByAddress;
+
+void SinkRxTrace(Ptr<const Packet> p, const Address &from)
+{
+  auto ue = ueByAddress.find(InetSocketAddress::ConvertFrom(from).GetIpv4().Get());
+  if (ue == ueByAddress.end()) {
+    return;
+  }
+  lpwan::UidTracker::Reception rx = uidTracker.RecordReceive(p->GetUid(), Simulator::Now().GetSeconds());
+  if (rx.status == lpwan::UidTracker::DUPLICATE) {
+    metrics.RecordDuplicate(ue->second);
+    return;
+  }
+  if (rx.status == lpwan::UidTracker::UNKNOWN) {
+    return;
+  }
+  metrics.RecordRx(ue->second, p->GetSize(), Simulator::Now().GetSeconds() - rx.sendTime);
 }
 
 void RetxTrace(Ptr<const Packet> p)
@@ -62,24 +126,175 @@ void RetxTrace(Ptr<const Packet> p)
   totalRetx++;
 }
 
-int main(int argc, char *argv[])
+// Parâmetros do cenário (iguais para todas as execuções)
+struct NbIotScenario
 {
-  uint32_t nUe = 10;
-  double simTime = 10.0;
-  double distance = 1000.0;
-  uint32_t packetsPerUe = 10;
+  uint32_t nUe;
+  double simTime;
+  double distance;
+  uint32_t packetsPerUe;
+  lpwan::PlacementConfig placement; // count e raio já preenchidos
+  bool uplinkOnly;
+  double reportInterval;
+  lpwan::PsmConfig psm;
+};
 
-  CommandLine cmd;
-  cmd.AddValue("nUe", "Número de UEs", nUe);
-  cmd.AddValue("simTime", "Tempo de simulação (s)", simTime);
-  cmd.AddValue("distance", "Distância entre eNB e UEs (m)", distance);
-  cmd.AddValue("packetsPerUe", "Qtd de pacotes por UE", packetsPerUe);
-  cmd.Parse(argc, argv);
+// Resultado de uma replicação (POD: volta dos workers por pipe)
+struct NbIotRunResult
+{
+  lpwan::RunResult result;
+  double batteryLifeDays; // do UE que mais consome, no ritmo da execução
+  uint64_t taus;
+  uint64_t expired; // enviados que saíram do anel de UIDs sem recepção
+  bool reduced;
+  lpwan::NbIotAccessStats access; // só no modelo reduzido
+  lpwan::RunProfile profile;
+  lpwan::LatencyReport latency;   // por nível de CE no modelo reduzido
+};
+
+// Energia de cada UE até o fim da execução; devolve a vida da bateria do
+// UE que mais consome
+double FinishEnergy(uint32_t nUe, double simTime)
+{
+  powerSaving.Finish(simTime);
+  double maxUeEnergy = 0.0;
+  for (uint32_t i = 0; i < nUe; ++i) {
+    double joules = radioEnergy.Energy(i, simTime);
+    metrics.AddEnergy(i, joules);
+    maxUeEnergy = std::max(maxUeEnergy, joules);
+  }
+  return maxUeEnergy > 0.0 ? initialEnergy / (maxUeEnergy / simTime) / 86400.0 : 0.0;
+}
+
+// Zera as métricas e o estado de energia entre execuções
+void ResetRun(const NbIotScenario &scenario)
+{
+  metrics.Reset(scenario.nUe);
+  uidTracker.Reset(scenario.nUe, scenario.simTime);
+  totalRetx = 0;
+  radioEnergy.Reset(lpwan::NbIotRadioProfile(), scenario.nUe, 0.0, lpwan::RADIO_IDLE); // conectado desde o attach
+  powerSaving.Reset(scenario.psm, &radioEnergy, scenario.nUe);
+}
+
+// Modelo reduzido (--model=reduced): sem LTE/EPC, só contenção NPRACH e
+// escalonador do NPUSCH (lpwan-nbiot-access.h). Os relatórios são de uplink
+// (sem eco), com fase inicial uniforme no intervalo; a saída é o mesmo bloco
+// de métricas e o mesmo shard do modelo completo. O acesso e o tráfego usam
+// fluxos fixos do RNG, então a execução não depende de --jobs.
+NbIotRunResult RunReducedModel(const NbIotScenario &scenario, uint32_t runNumber)
+{
+  profiler.Begin(lpwan::PHASE_BUILD);
+  RngSeedManager::SetRun(runNumber);
+  ResetRun(scenario);
+  uint32_t nUe = scenario.nUe;
+  double simTime = scenario.simTime;
+  lpwan::PlacementConfig placement = scenario.placement;
+  placement.seed = lpwan::PlacementSeed(RngSeedManager::GetSeed(), runNumber);
+  lpwan::Placement positions = lpwan::GeneratePlacement(placement);
+
+  // Perda de percurso do eNB (na origem) até cada UE, como no nbiot_simplificado
+  lpwan::LinkBudgetParams budget;
+  budget.txPowerDbm = ueTxPower;
+  budget.pathLossExponent = 3.5;
+  budget.referenceLossDb = 8.0;
+  const double origin = 0.0;
+  lpwan::LinkBudgetTable linkBudget;
+  linkBudget.Build(budget, positions.x.data(), positions.y.data(), positions.z.data(), nUe, &origin, &origin,
+                   &origin, 1);
+
+  profiler.Begin(lpwan::PHASE_INSTALL);
+  lpwan::NbIotAccessConfig accessConfig;
+  accessConfig.txPowerDbm = ueTxPower;
+  lpwan::NbIotAccessModel access;
+  int64_t stream = access.AssignStreams(0);
+  access.Install(accessConfig, linkBudget, &powerSaving, [](uint32_t ue, double sendTime) {
+    metrics.RecordRx(ue, 50, Simulator::Now().GetSeconds() - sendTime);
+  });
+  metrics.SetLatencyClasses({"CE0", "CE1", "CE2"});
+  for (uint32_t ue = 0; ue < nUe; ++ue) {
+    if (access.GetCoverageClass(ue) >= 0) {
+      metrics.SetClass(ue, access.GetCoverageClass(ue));
+    }
+  }
+
+  lpwan::TrafficConfig trafficConfig;
+  trafficConfig.pattern = lpwan::TRAFFIC_PERIODIC;
+  trafficConfig.start = 2.0;
+  trafficConfig.period = scenario.reportInterval;
+  trafficConfig.stop = simTime;
+  trafficConfig.maxPackets = scenario.packetsPerUe;
+  lpwan::TrafficGenerator traffic;
+  traffic.AssignStreams(stream);
+  traffic.Install(nUe, trafficConfig, [&access](uint32_t ue) {
+    metrics.RecordTx(ue);
+    access.Report(ue);
+  });
+
+  Simulator::Stop(Seconds(simTime));
+  profiler.Begin(lpwan::PHASE_RUN);
+  Simulator::Run();
+  profiler.End();
 
-  // Helpers principais
+  NbIotRunResult out;
+  out.batteryLifeDays = FinishEnergy(nUe, simTime);
+  out.taus = powerSaving.GetTauCount();
+  out.expired = 0; // o modelo reduzido entrega pela fila do UE, sem UIDs
+  out.reduced = true;
+  out.access = access.GetStats();
+
+  lpwan::MetricsTotals totals = metrics.Aggregate();
+  double bandaUtilizada = 180.0;
+
+  lpwan::RunResult &result = out.result;
+  result = lpwan::RunResult{};
+  result.run = runNumber;
+  result.devices = nUe;
+  result.distance = scenario.distance;
+  result.packetsSent = totals.tx;
+  result.packetsReceived = totals.rx;
+  result.packetsDuplicated = totals.duplicates;
+  result.pdr = totals.tx > 0 ? ((double)totals.rx / totals.tx) * 100 : 0;
+  result.plr = totals.tx > 0 ? ((double)(totals.tx - totals.rx) / totals.tx) * 100 : 0;
+  result.retransmissionRate = totals.rx > 0 ? ((double)out.access.collisions / totals.rx) * 100 : 0; // preâmbulos repetidos
+  result.averageDelay = totals.rx > 0 ? totals.delaySum / totals.rx : 0;
+  lpwan::FillDelayPercentiles(result, metrics.GetLatency().all);
+  result.throughput = totals.rx * 50 * 8 / simTime;
+  result.bandwidthUsed = bandaUtilizada;
+  result.channelUtilization = out.access.toneSeconds / (simTime * lpwan::NBIOT_SUBCARRIERS) * 100; // % do NPUSCH
+  result.energyConsumption = totals.energy;
+
+  out.latency = metrics.GetLatency();
+  profiler.Begin(lpwan::PHASE_TEARDOWN);
+  Simulator::Destroy();
+  out.profile = profiler.Finish();
+  return out;
+}
+
+// Topologia LTE/EPC: nós, dispositivos, attach, aplicações e traces. Nada
+// aqui depende da execução; posições e fluxos do RNG ficam em RunOnTopology,
+// então a mesma topologia serve a várias replicações (--reuseTopology)
+struct NbIotTopology
+{
+  Ptr<LteHelper> lteHelper;
+  NodeContainer ueNodes;
+  NetDeviceContainer enbLteDevs;
+  NetDeviceContainer ueLteDevs;
+};
+
+NbIotTopology BuildTopology(const NbIotScenario &scenario)
+{
+  profiler.Begin(lpwan::PHASE_BUILD);
+  NbIotTopology topology;
+  uint32_t nUe = scenario.nUe;
+  bool uplinkOnly = scenario.uplinkOnly;
+
+  // Helpers principais (SRS no maior período: o padrão de 40 ms limita a
+  // célula a 40 UEs)
+  Config::SetDefault("ns3::LteEnbRrc::SrsPeriodicity", UintegerValue(lteMaxUesPerCell));
   Ptr<LteHelper> lteHelper = CreateObject<LteHelper>();
   Ptr<PointToPointEpcHelper> epcHelper = CreateObject<PointToPointEpcHelper>();
   lteHelper->SetEpcHelper(epcHelper);
+  topology.lteHelper = lteHelper;
 
   // Internet para o Remote Host
   NodeContainer remoteHostContainer;
@@ -102,27 +317,24 @@ int main(int argc, char *argv[])
   remoteRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
 
   // Criar eNB e UEs
-  NodeContainer ueNodes;
+  NodeContainer &ueNodes = topology.ueNodes;
   NodeContainer enbNodes;
   enbNodes.Create(1);
   ueNodes.Create(nUe);
 
-  // Mobilidade
-  MobilityHelper mobility;
-  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
-  positionAlloc->Add(Vector(0.0, 0.0, 0.0)); // eNB fixo
-  for (uint32_t i = 0; i < nUe; ++i)
-  {
-    positionAlloc->Add(Vector(distance, 0.0 + i, 0.0)); // UEs na mesma distância
-  }
-  mobility.SetPositionAllocator(positionAlloc);
-  mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-  mobility.Install(enbNodes);
-  mobility.Install(ueNodes);
+  // Mobilidade: eNB fixo; os UEs ficam na origem até cada replicação
+  // instalar as posições da sua execução
+  lpwan::InstallPosition(enbNodes.Get(0), 0.0, 0.0, 0.0);
+  lpwan::Placement origin;
+  origin.resize(nUe);
+  lpwan::InstallPlacement(ueNodes, origin);
 
   // Instala dispositivos LTE
+  profiler.Begin(lpwan::PHASE_INSTALL);
   NetDeviceContainer enbLteDevs = lteHelper->InstallEnbDevice(enbNodes);
   NetDeviceContainer ueLteDevs = lteHelper->InstallUeDevice(ueNodes);
+  topology.enbLteDevs = enbLteDevs;
+  topology.ueLteDevs = ueLteDevs;
 
   // Instala internet e IP
   internet.Install(ueNodes);
@@ -141,67 +353,302 @@ int main(int argc, char *argv[])
     lteHelper->Attach(ueLteDevs.Get(i), enbLteDevs.Get(0));
   }
 
-  // Aplicações (UDP Echo como exemplo de envio)
+  // Aplicações: UDP Echo (um servidor por UE) ou, com --uplinkOnly, um só
+  // PacketSink e clientes UDP sem resposta
   uint16_t port = 8000;
   ApplicationContainer serverApps, clientApps;
-  for (uint32_t i = 0; i < ueNodes.GetN(); ++i)
+  Ipv4Address remoteAddress = remoteHost->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+  if (uplinkOnly)
   {
-    UdpEchoServerHelper echoServer(port);
-    serverApps.Add(echoServer.Install(remoteHost));
+    PacketSinkHelper sink("ns3::UdpSocketFactory", InetSocketAddress(port));
+    serverApps = sink.Install(remoteHost);
 
-    UdpEchoClientHelper echoClient(remoteHost->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal(), port);
-    echoClient.SetAttribute("MaxPackets", UintegerValue(packetsPerUe));
-    echoClient.SetAttribute("Interval", TimeValue(MilliSeconds(500)));
-    echoClient.SetAttribute("PacketSize", UintegerValue(50));
-    clientApps.Add(echoClient.Install(ueNodes.Get(i)));
+    UdpClientHelper client(remoteAddress, port);
+    client.SetAttribute("MaxPackets", UintegerValue(scenario.packetsPerUe));
+    client.SetAttribute("Interval", TimeValue(Seconds(scenario.reportInterval)));
+    client.SetAttribute("PacketSize", UintegerValue(50));
+    clientApps = client.Install(ueNodes);
+
+    ueByAddress.clear();
+    for (uint32_t i = 0; i < ueNodes.GetN(); ++i)
+    {
+      ueByAddress[ueIpIface.GetAddress(i).Get()] = i;
+    }
+  }
+  else
+  {
+    for (uint32_t i = 0; i < ueNodes.GetN(); ++i)
+    {
+      UdpEchoServerHelper echoServer(port);
+      serverApps.Add(echoServer.Install(remoteHost));
+
+      UdpEchoClientHelper echoClient(remoteAddress, port);
+      echoClient.SetAttribute("MaxPackets", UintegerValue(scenario.packetsPerUe));
+      echoClient.SetAttribute("Interval", TimeValue(Seconds(scenario.reportInterval)));
+      echoClient.SetAttribute("PacketSize", UintegerValue(50));
+      clientApps.Add(echoClient.Install(ueNodes.Get(i)));
+    }
   }
 
   serverApps.Start(Seconds(1.0));
   clientApps.Start(Seconds(2.0));
-  startTime = Seconds(2.0);
 
-  // Traços de métricas
-  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::UdpEchoClient/Tx", MakeCallback(&TxTrace));
-  Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::UdpEchoServer/Rx", MakeCallback(&RxTrace));
+  // Traços de métricas: cada cliente recebe o índice do seu UE
+  for (uint32_t i = 0; i < clientApps.GetN(); ++i)
+  {
+    clientApps.Get(i)->TraceConnectWithoutContext("Tx", MakeBoundCallback(&TxTrace, i));
+    if (!uplinkOnly) {
+      clientApps.Get(i)->TraceConnectWithoutContext("Rx", MakeBoundCallback(&UeRxTrace, i));
+    }
+  }
+  for (uint32_t i = 0; i < serverApps.GetN(); ++i)
+  {
+    if (uplinkOnly) {
+      serverApps.Get(i)->TraceConnectWithoutContext("Rx", MakeCallback(&SinkRxTrace));
+    } else {
+      serverApps.Get(i)->TraceConnectWithoutContext("Rx", MakeCallback(&RxTrace));
+    }
+  }
+  profiler.End();
+  return topology;
+}
+
+// Executa uma replicação sobre a topologia montada. Os objetos aleatórios
+// da topologia (LTE e pilha IP) recebem fluxos fixos do RNG, recriados com a
+// execução atual, e as posições dos UEs são as da execução; com topologia
+// nova ou herdada de um fork o resultado é o mesmo.
+NbIotRunResult RunOnTopology(const NbIotScenario &scenario, NbIotTopology &topology, uint32_t runNumber)
+{
+  profiler.Begin(lpwan::PHASE_INSTALL);
+  RngSeedManager::SetRun(runNumber);
+  int64_t stream = topology.lteHelper->AssignStreams(topology.enbLteDevs, 0);
+  stream += topology.lteHelper->AssignStreams(topology.ueLteDevs, stream);
+  InternetStackHelper internet;
+  internet.AssignStreams(NodeContainer::GetGlobal(), stream);
+
+  lpwan::PlacementConfig placement = scenario.placement;
+  placement.seed = lpwan::PlacementSeed(RngSeedManager::GetSeed(), runNumber);
+  lpwan::InstallPlacement(topology.ueNodes, lpwan::GeneratePlacement(placement));
+
+  ResetRun(scenario);
+  uint32_t nUe = scenario.nUe;
+  double simTime = scenario.simTime;
 
   Simulator::Stop(Seconds(simTime));
+  profiler.Begin(lpwan::PHASE_RUN);
   Simulator::Run();
+  profiler.End();
+
+  NbIotRunResult out;
+  out.batteryLifeDays = FinishEnergy(nUe, simTime);
+  out.taus = powerSaving.GetTauCount();
+  out.expired = uidTracker.GetExpired();
+  out.reduced = false;
+  out.access = lpwan::NbIotAccessStats{};
 
   // Cálculo das métricas
-  double pdr = totalTx > 0 ? ((double)totalRx / totalTx) * 100 : 0;
-  double plr = totalTx > 0 ? ((double)(totalTx - totalRx) / totalTx) * 100 : 0;
-  double retransmissionRate = totalRx > 0 ? ((double)totalRetx / totalRx) * 100 : 0;
-  double atrasoMedio = totalRx > 0 ? totalDelay / totalRx : 0;
-  double vazao = totalRx * 50 * 8 / simTime; // bps
+  lpwan::MetricsTotals totals = metrics.Aggregate();
   double bandaUtilizada = 180.0; // NB-IoT usa 180 kHz
-  double channelUtilization = (totalTx * 50 * 8) / (simTime * bandaUtilizada * 1000) * 100; // %
-  double energyConsumption = totalEnergyConsumption;
-
-  // Saída padronizada
-  std::cout << "=== RESULTADOS NB-IOT ===" << std::endl;
-  std::cout << "Execução: 1" << std::endl;
-  std::cout << "Distância (m): " << distance << std::endl;
-  std::cout << "Dispositivos: " << nUe << std::endl;
-  std::cout << "Pacotes Enviados: " << totalTx << std::endl;
-  std::cout << "Pacotes Recebidos: " << totalRx << std::endl;
-  std::cout << "Pacotes Duplicados: " << totalDuplicated << std::endl;
-  std::cout << "PDR (%): " << pdr << std::endl;
-  std::cout << "PLR (%): " << plr << std::endl;
-  std::cout << "Retransmissão (%): " << retransmissionRate << std::endl;
-  std::cout << "Vazão (bps): " << vazao << std::endl;
-  std::cout << "Utilização do Canal (%): " << channelUtilization << std::endl;
-  std::cout << "Atraso Médio (s): " << atrasoMedio << std::endl;
-  std::cout << "Banda Utilizada (kHz): " << bandaUtilizada << std::endl;
-  std::cout << "Consumo Energia (J): " << energyConsumption << std::endl;
-
-  // Gerar arquivo CSV
-  std::ofstream csvFile("resultados_nbiot.csv");
-  csvFile << "Execução,Distância (m),Dispositivos,Pacotes Enviados,Pacotes Recebidos,Pacotes Duplicados,PDR (%),PLR (%),Retransmissão (%),Vazão (bps),Utilização do Canal (%),Atraso Médio (s),Banda Utilizada (kHz),Consumo Energia (J)\n";
-  csvFile << "1," << distance << "," << nUe << "," << totalTx << "," << totalRx << "," << totalDuplicated << "," 
-          << pdr << "," << plr << "," << retransmissionRate << "," << vazao << "," << channelUtilization << "," 
-          << atrasoMedio << "," << bandaUtilizada << "," << energyConsumption << "\n";
-  csvFile.close();
 
+  lpwan::RunResult &result = out.result;
+  result = lpwan::RunResult{};
+  result.run = runNumber;
+  result.devices = nUe;
+  result.distance = scenario.distance;
+  result.packetsSent = totals.tx;
+  result.packetsReceived = totals.rx;
+  result.packetsDuplicated = totals.duplicates;
+  result.pdr = totals.tx > 0 ? ((double)totals.rx / totals.tx) * 100 : 0;
+  result.plr = totals.tx > 0 ? ((double)(totals.tx - totals.rx) / totals.tx) * 100 : 0;
+  result.retransmissionRate = totals.rx > 0 ? ((double)totalRetx / totals.rx) * 100 : 0;
+  result.averageDelay = totals.rx > 0 ? totals.delaySum / totals.rx : 0;
+  lpwan::FillDelayPercentiles(result, metrics.GetLatency().all);
+  result.throughput = totals.rx * 50 * 8 / simTime; // bps
+  result.bandwidthUsed = bandaUtilizada;
+  result.channelUtilization = (totals.tx * 50 * 8) / (simTime * bandaUtilizada * 1000) * 100; // %
+  result.energyConsumption = totals.energy;
+
+  out.latency = metrics.GetLatency();
+  profiler.Begin(lpwan::PHASE_TEARDOWN);
   Simulator::Destroy();
+  out.profile = profiler.Finish();
+  return out;
+}
+
+// Replicação a frio: monta a topologia da execução e roda
+NbIotRunResult RunReplication(const NbIotScenario &scenario, uint32_t runNumber)
+{
+  RngSeedManager::SetRun(runNumber);
+  NbIotTopology topology = BuildTopology(scenario);
+  return RunOnTopology(scenario, topology, runNumber);
+}
+
+int main(int argc, char *argv[])
+{
+  NbIotScenario scenario;
+  scenario.nUe = 10;
+  scenario.simTime = 10.0;
+  scenario.distance = 1000.0;
+  scenario.packetsPerUe = 10;
+  scenario.uplinkOnly = false;      // relatórios de sensor sem eco
+  scenario.reportInterval = 0.5;    // s entre pacotes de cada UE
+  lpwan::PlacementConfig &placement = scenario.placement; // UEs a `distance` do eNB (anel)
+  lpwan::PsmConfig &psm = scenario.psm;
+  std::string model = "lte";        // lte (pilha completa) ou reduced
+  uint32_t numExecutions = 1;       // execuções a partir de --RngRun
+  uint32_t jobs = 1;                // replicações simultâneas (processos)
+  bool reuseTopology = false;       // monta a topologia uma vez e faz fork por replicação
+  bool profile = false;             // tempo por fase, eventos e memória na saída e no CSV
+
+  CommandLine cmd;
+  cmd.AddValue("nUe", "Número de UEs", scenario.nUe);
+  cmd.AddValue("simTime", "Tempo de simulação (s)", scenario.simTime);
+  cmd.AddValue("distance", "Distância entre eNB e UEs (m)", scenario.distance);
+  cmd.AddValue("packetsPerUe", "Qtd de pacotes por UE", scenario.packetsPerUe);
+  cmd.AddValue("layout", "Posição dos UEs: annulus, disc, grid, hex, line ou file", placement.layout);
+  cmd.AddValue("layoutWidth", "Largura do anel no layout annulus (m)", placement.width);
+  cmd.AddValue("layoutSpacing", "Espaçamento dos layouts grid, hex e line (m)", placement.spacing);
+  cmd.AddValue("layoutFile", "Arquivo de posições do layout file (CSV/texto ou .bin)", placement.file);
+  cmd.AddValue("uplinkOnly", "Só uplink: um PacketSink no remote host para todos os UEs, sem eco", scenario.uplinkOnly);
+  cmd.AddValue("reportInterval", "Intervalo entre pacotes de cada UE (s)", scenario.reportInterval);
+  cmd.AddValue("psm", "Economia de energia: idle com eDRX por T3324, depois PSM com TAU a cada T3412", psm.enabled);
+  cmd.AddValue("t3324", "Active timer T3324 (s)", psm.t3324);
+  cmd.AddValue("t3412", "Temporizador de TAU periódico T3412 (s)", psm.t3412);
+  cmd.AddValue("edrxCycle", "Ciclo de eDRX em idle (s, 0 = DRX de 1,28 s)", psm.edrxCycle);
+  cmd.AddValue("ptw", "Janela de paging em cada ciclo de eDRX (s)", psm.ptw);
+  cmd.AddValue("model", "Modelo: lte (LTE/EPC completo) ou reduced (NPRACH + escalonador, sem pilha)", model);
+  cmd.AddValue("numExecutions", "Execuções a partir de --RngRun", numExecutions);
+  cmd.AddValue("jobs", "Replicações simultâneas em processos isolados", jobs);
+  cmd.AddValue("reuseTopology", "Monta a topologia LTE/EPC uma vez e roda cada replicação num fork dela", reuseTopology);
+  cmd.AddValue("profile", "Tempo por fase, eventos/s, pico de memória e alocações por evento", profile);
+  cmd.Parse(argc, argv);
+  NS_ABORT_MSG_IF(model != "lte" && model != "reduced", "--model deve ser lte ou reduced");
+  if (model == "lte" && scenario.nUe > lteMaxUesPerCell)
+  {
+    std::cerr << "O modelo lte comporta até " << lteMaxUesPerCell
+              << " UEs numa célula (configurações de SRS do LteEnbRrc); use --model=reduced" << std::endl;
+    return 1;
+  }
+  lpwan::TrafficConfig reports; // mesma validação do gerador de tráfego
+  reports.period = scenario.reportInterval;
+  try
+  {
+    lpwan::ValidateTrafficConfig(reports);
+  }
+  catch (const std::invalid_argument &e)
+  {
+    std::cerr << "--reportInterval: " << e.what() << std::endl;
+    return 1;
+  }
+  profiler.Enable(profile);
+
+  uint32_t nUe = scenario.nUe;
+  double simTime = scenario.simTime;
+  placement.count = nUe;
+  placement.radius = scenario.distance;
+
+  // Hash da configuração para o shard (CSV + .lpwr). Modo uplink, intervalo,
+  // PSM, modelo e layout só entram no hash fora do padrão (shards antigos
+  // mantêm o hash)
+  lpwan::ConfigHash hash;
+  hash.Add("nUe", nUe)
+      .Add("simTime", simTime)
+      .Add("distance", scenario.distance)
+      .Add("packetsPerUe", scenario.packetsPerUe);
+  if (!placement.IsDefault("annulus")) {
+    hash.Add("layout", placement.Describe());
+  }
+  if (scenario.uplinkOnly) {
+    hash.Add("uplinkOnly", 1);
+  }
+  if (scenario.reportInterval != 0.5) {
+    hash.Add("reportInterval", scenario.reportInterval);
+  }
+  if (psm.enabled) {
+    hash.Add("psm", psm.Describe());
+  }
+  if (model != "lte") {
+    hash.Add("model", model);
+  }
+  uint64_t configHash = hash.Get();
+
+  std::vector<uint32_t> runs;
+  for (uint32_t i = 0; i < std::max(numExecutions, 1u); ++i) {
+    runs.push_back(RngSeedManager::GetRun() + i);
+  }
+
+  // Com --reuseTopology a topologia LTE/EPC é montada uma vez neste processo
+  // e cada replicação roda num filho (fork, cópia sob escrita); o modelo
+  // reduzido não tem topologia para reaproveitar. Falha de um worker (ou de
+  // pipe/fork/poll) chega aqui como exceção
+  std::vector<NbIotRunResult> results;
+  try
+  {
+    if (model == "reduced") {
+      results = lpwan::RunReplications<NbIotRunResult>(
+          runs, jobs, [&scenario](uint32_t runNumber) { return RunReducedModel(scenario, runNumber); });
+    } else if (reuseTopology) {
+      RngSeedManager::SetRun(runs.front());
+      NbIotTopology topology = BuildTopology(scenario);
+      results = lpwan::ForkReplications<NbIotRunResult>(
+          runs, jobs, [&scenario, &topology](uint32_t runNumber) { return RunOnTopology(scenario, topology, runNumber); });
+      Simulator::Destroy();
+    } else {
+      results = lpwan::RunReplications<NbIotRunResult>(
+          runs, jobs, [&scenario](uint32_t runNumber) { return RunReplication(scenario, runNumber); });
+    }
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  // Shard próprio (CSV + .lpwr) com semente, execução e hash da configuração
+  lpwan::ResultSink sink("resultados_nbiot", lpwan::TECH_NBIOT, "nb-iot-sim", RngSeedManager::GetSeed(), configHash, simTime);
+  if (profile) {
+    sink.SetExtraColumns(lpwan::ProfileCsvHeader());
+  }
+  for (const NbIotRunResult &run : results)
+  {
+    // Saída padronizada
+    lpwan::PrintRunResult(std::cout, "NB-IOT", run.result);
+    lpwan::PrintRunProfile(std::cout, run.profile);
+    lpwan::PrintLatencyReport(std::cout, run.latency);
+    std::cout << "Vida da Bateria (dias): " << run.batteryLifeDays << std::endl;
+    if (!run.reduced) {
+      std::cout << "Pacotes Expirados: " << run.expired << std::endl;
+    }
+    if (psm.enabled) {
+      std::cout << "TAUs Periódicos: " << run.taus << std::endl;
+    }
+    if (run.reduced) {
+      const lpwan::NbIotAccessStats &stats = run.access;
+      std::cout << "Preâmbulos NPRACH: " << stats.preambles << std::endl;
+      std::cout << "Colisões NPRACH: " << stats.collisions << std::endl;
+      std::cout << "Falhas de Acesso: " << stats.accessFailures << std::endl;
+      std::cout << "Fora de Cobertura: " << stats.outOfCoverage << std::endl;
+      std::cout << "UEs por CE (0/1/2): " << stats.uesPerCe[0] << "/" << stats.uesPerCe[1] << "/"
+                << stats.uesPerCe[2] << std::endl;
+    }
+    if (profile) {
+      sink.Add(run.result, lpwan::ProfileCsvRow(run.profile));
+    } else {
+      sink.Add(run.result);
+    }
+    sink.Flush();
+  }
+
+  // Atraso de todas as execuções juntas: os histogramas se somam, então a
+  // cauda é a da amostra inteira e não uma média de percentis
+  if (results.size() > 1) {
+    lpwan::LatencyReport latency = results.front().latency;
+    for (size_t i = 1; i < results.size(); ++i) {
+      latency.Merge(results[i].latency);
+    }
+    std::cout << "=== ATRASO NB-IOT (" << results.size() << " execuções) ===" << std::endl;
+    std::cout << "Atraso p50/p90/p99/máx (s): " << lpwan::FormatPercentiles(latency.all) << std::endl;
+    lpwan::PrintLatencyReport(std::cout, latency);
+  }
   return 0;
 }
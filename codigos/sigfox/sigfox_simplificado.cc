@@ -7,10 +7,17 @@
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/mobility-module.h"
-#include "ns3/energy-module.h"
+#include "ns3/internet-module.h"
 #include "ns3/applications-module.h"
-#include "ns3/wifi-module.h"
 #include "ns3/propagation-module.h"
+#include "../comum/lpwan-metrics.h"
+#include "../comum/lpwan-uid-tracker.h"
+#include "../comum/lpwan-run-result.h"
+#include "../comum/lpwan-result-sink.h"
+#include "../comum/lpwan-uplink-channel.h"
+#include "../comum/lpwan-placement.h"
+#include "../comum/lpwan-radio-energy.h"
+#include "../comum/lpwan-profile.h"
 #include <fstream>
 #include <iostream>
 #include <vector>
@@ -19,33 +26,58 @@ using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("SigfoxSimplificado");
 
-// Variáveis globais
-uint32_t packetsSent = 0;
-uint32_t packetsReceived = 0;
-uint32_t packetsDuplicated = 0;
-double totalDelay = 0.0;
-double totalThroughput = 0.0;
-double totalEnergyConsumption = 0.0;
+// Variáveis globais (métricas por dispositivo, índice = posição em endDevices)
+lpwan::MetricsStore metrics;
+lpwan::UidTracker uidTracker;
 double distance = 1000.0;
 uint32_t nDevices = 10;
+double sensitivity = -142.0; // dBm (Sigfox)
+// Energia: transições do rádio (TX a 100 bps, sleep entre envios),
+// integradas no fim da execução
+lpwan::RadioEnergyLog radioEnergy;
+lpwan::PlacementConfig placement; // padrão line: (distance, i × 10 m), posições originais
+bool profile = false;            // --profile: tempo por fase, eventos e memória
+lpwan::Profiler profiler;
 
 // Callbacks para métricas
-void TxTrace(Ptr<const Packet> packet) {
-    packetsSent++;
-    totalEnergyConsumption += 0.1; // 0.1 J por transmissão
+void TxTrace(uint32_t dev, Ptr<const Packet> packet) {
+    metrics.RecordTx(dev);
+    uidTracker.RecordSend(packet->GetUid(), dev, Simulator::Now().GetSeconds());
+    radioEnergy.Burst(dev, Simulator::Now().GetSeconds(), packet->GetSize() * 8 / 100.0, lpwan::RADIO_TX);
 }
 
-void RxTrace(Ptr<const Packet> packet, const Address &addr) {
-    packetsReceived++;
-    totalDelay += Simulator::Now().GetSeconds() - 1.0; // Tempo desde início
-    totalThroughput += packet->GetSize() * 8; // bits
+void RxTrace(Ptr<const Packet> packet) {
+    lpwan::UidTracker::Reception rx = uidTracker.RecordReceive(packet->GetUid(), Simulator::Now().GetSeconds());
+    if (rx.status == lpwan::UidTracker::DUPLICATE) {
+        if (rx.dev != lpwan::UidTracker::NO_DEVICE) {
+            metrics.RecordDuplicate(rx.dev);
+        }
+        return;
+    }
+    if (rx.status == lpwan::UidTracker::UNKNOWN) {
+        return; // Não enviado nesta execução ou já expirado
+    }
+    metrics.RecordRx(rx.dev, packet->GetSize(), Simulator::Now().GetSeconds() - rx.sendTime);
 }
 
 int main(int argc, char *argv[]) {
+    placement.layout = "line"; // mantém as posições da versão original
     CommandLine cmd;
     cmd.AddValue("distance", "Distância entre dispositivos e gateway (m)", distance);
     cmd.AddValue("nDevices", "Número de dispositivos", nDevices);
+    cmd.AddValue("sensitivity", "Sensibilidade do receptor do gateway (dBm)", sensitivity);
+    cmd.AddValue("layout", "Posição dos dispositivos: annulus, disc, grid, hex, line ou file", placement.layout);
+    cmd.AddValue("layoutWidth", "Largura do anel no layout annulus (m)", placement.width);
+    cmd.AddValue("layoutSpacing", "Espaçamento dos layouts grid, hex e line (m)", placement.spacing);
+    cmd.AddValue("layoutFile", "Arquivo de posições do layout file (CSV/texto ou .bin)", placement.file);
+    cmd.AddValue("profile", "Tempo por fase, eventos/s, pico de memória e alocações por evento", profile);
     cmd.Parse(argc, argv);
+    profiler.Enable(profile);
+    profiler.Begin(lpwan::PHASE_BUILD);
+
+    metrics.Reset(nDevices);
+    uidTracker.Reset(nDevices, 60.0); // maxAge = duração da simulação
+    radioEnergy.Reset(lpwan::SigfoxRadioProfile(), nDevices);
 
     // Configurar seed para reprodutibilidade
     RngSeedManager::SetSeed(12345);
@@ -56,60 +88,51 @@ int main(int argc, char *argv[]) {
     endDevices.Create(nDevices);
     gateway.Create(1);
 
-    // Configurar mobilidade
-    MobilityHelper mobility;
-    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
-    
-    // Gateway na origem
-    positionAlloc->Add(Vector(0.0, 0.0, 0.0));
-    
-    // Dispositivos distribuídos
-    for (uint32_t i = 0; i < nDevices; ++i) {
-        positionAlloc->Add(Vector(distance, 0.0 + i * 10, 0.0));
-    }
-    
-    mobility.SetPositionAllocator(positionAlloc);
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mobility.Install(gateway);
-    mobility.Install(endDevices);
+    // Gateway na origem; dispositivos pelo layout escolhido
+    placement.count = nDevices;
+    placement.radius = distance;
+    placement.seed = lpwan::PlacementSeed(RngSeedManager::GetSeed(), RngSeedManager::GetRun());
+    lpwan::InstallPosition(gateway.Get(0), 0.0, 0.0, 0.0);
+    lpwan::Placement positions = lpwan::GeneratePlacement(placement);
+    lpwan::InstallPlacement(endDevices, positions);
 
     // Configurar canal de propagação (simulando Sigfox)
     Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
     loss->SetPathLossExponent(3.76); // Típico para ambiente urbano
     loss->SetReference(1, 7.7);
 
-    Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
-    Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel>();
-    channel->SetPropagationLossModel(loss);
-    channel->SetPropagationDelayModel(delay);
-
-    // Configurar WiFi (usando como base para simular Sigfox)
-    YansWifiPhyHelper phy;
-    phy.SetChannel(channel);
-    phy.Set("TxPowerStart", DoubleValue(14.0)); // 14 dBm (típico Sigfox)
-    phy.Set("TxPowerEnd", DoubleValue(14.0));
-    phy.Set("ChannelNumber", UintegerValue(1));
-
-    WifiMacHelper mac;
-    mac.SetType("ns3::AdhocWifiMac");
-
-    WifiHelper wifi;
-    wifi.SetStandard(WIFI_PHY_STANDARD_80211b);
-    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
-                                "DataMode", StringValue("DsssRate1Mbps"),
-                                "ControlMode", StringValue("DsssRate1Mbps"));
-
-    // Instalar dispositivos
-    NetDeviceContainer endDeviceDevices = wifi.Install(phy, mac, endDevices);
-    NetDeviceContainer gatewayDevices = wifi.Install(phy, mac, gateway);
-
-    // Configurar energia
-    BasicEnergySourceHelper energySource;
-    energySource.Set("BasicEnergySourceInitialEnergyJ", DoubleValue(3600.0));
-    EnergySourceContainer sources = energySource.Install(endDevices);
-
-    WifiRadioEnergyModelHelper radioEnergyHelper;
-    DeviceEnergyModelContainer deviceModels = radioEnergyHelper.Install(endDeviceDevices, sources);
+    // Canal de uplink com recorte espacial: dispositivos não se ouvem e cada
+    // transmissão só chega aos gateways dentro do alcance da sensibilidade
+    Ptr<lpwan::UplinkChannel> channel = CreateObject<lpwan::UplinkChannel>();
+    channel->SetPropagation(loss, 14.0, sensitivity); // 14 dBm (típico Sigfox)
+
+    // Potência de cada dispositivo no gateway calculada uma vez, em lote
+    lpwan::LinkBudgetParams budget;
+    budget.txPowerDbm = 14.0;
+    budget.pathLossExponent = 3.76;
+    budget.referenceLossDb = 7.7;
+    const double origin = 0.0;
+    lpwan::LinkBudgetTable linkBudget;
+    linkBudget.Build(budget, positions.x.data(), positions.y.data(), positions.z.data(), nDevices, &origin, &origin,
+                     &origin, 1);
+    channel->SetLinkBudget(&linkBudget);
+
+    profiler.Begin(lpwan::PHASE_INSTALL);
+    SimpleNetDeviceHelper deviceHelper;
+    deviceHelper.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100bps"))); // Sigfox UNB uplink
+    NetDeviceContainer endDeviceDevices = deviceHelper.Install(endDevices, channel);
+    NetDeviceContainer gatewayDevices = deviceHelper.Install(gateway, channel);
+    channel->AddGateway(gatewayDevices.Get(0));
+
+    InternetStackHelper internet;
+    internet.Install(gateway);
+    internet.Install(endDevices);
+
+    Ipv4AddressHelper address;
+    address.SetBase("10.1.0.0", "255.255.0.0");
+    Ipv4InterfaceContainer gatewayInterfaces = address.Assign(gatewayDevices);
+    address.Assign(endDeviceDevices);
+    lpwan::PopulateStarArp(gatewayDevices, endDeviceDevices);
 
     // Configurar aplicações
     uint16_t port = 8000;
@@ -122,7 +145,7 @@ int main(int argc, char *argv[]) {
     serverApps.Stop(Seconds(60.0));
 
     // Clientes nos dispositivos
-    UdpEchoClientHelper echoClient(gateway.Get(0)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal(), port);
+    UdpEchoClientHelper echoClient(gatewayInterfaces.GetAddress(0), port);
     echoClient.SetAttribute("MaxPackets", UintegerValue(10));
     echoClient.SetAttribute("Interval", TimeValue(Seconds(60.0))); // Sigfox: 1 mensagem por hora
     echoClient.SetAttribute("PacketSize", UintegerValue(12)); // Tamanho típico Sigfox
@@ -135,47 +158,65 @@ int main(int argc, char *argv[]) {
     clientApps.Stop(Seconds(60.0));
 
     // Conectar callbacks
-    Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::UdpEchoClient/Tx", MakeCallback(&TxTrace));
-    Config::ConnectWithoutContext("/NodeList/*/ApplicationList/*/$ns3::UdpEchoServer/Rx", MakeCallback(&RxTrace));
+    for (uint32_t i = 0; i < clientApps.GetN(); ++i) {
+        clientApps.Get(i)->TraceConnectWithoutContext("Tx", MakeBoundCallback(&TxTrace, i));
+    }
+    serverApps.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&RxTrace));
 
     // Executar simulação
     Simulator::Stop(Seconds(60.0));
+    profiler.Begin(lpwan::PHASE_RUN);
     Simulator::Run();
+    profiler.End();
+    for (uint32_t i = 0; i < nDevices; ++i) {
+        metrics.AddEnergy(i, radioEnergy.Energy(i, 60.0));
+    }
 
     // Calcular métricas finais
-    double pdr = packetsSent > 0 ? ((double)packetsReceived / packetsSent) * 100 : 0;
-    double plr = packetsSent > 0 ? ((double)(packetsSent - packetsReceived) / packetsSent) * 100 : 0;
-    double retransmissionRate = 0.0; // Sigfox não tem retransmissão
-    double throughput = totalThroughput / 60.0; // bps
-    double avgDelay = packetsReceived > 0 ? totalDelay / packetsReceived : 0;
+    lpwan::MetricsTotals totals = metrics.Aggregate();
     double bandwidthUsed = 100.0; // Sigfox usa 100 kHz
-    double channelUtilization = (packetsSent * 12 * 8) / (60.0 * bandwidthUsed * 1000) * 100;
-
-    // Saída padronizada
-    std::cout << "=== RESULTADOS SIGFOX (SIMPLIFICADO) ===" << std::endl;
-    std::cout << "Execução: 1" << std::endl;
-    std::cout << "Distância (m): " << distance << std::endl;
-    std::cout << "Dispositivos: " << nDevices << std::endl;
-    std::cout << "Pacotes Enviados: " << packetsSent << std::endl;
-    std::cout << "Pacotes Recebidos: " << packetsReceived << std::endl;
-    std::cout << "Pacotes Duplicados: " << packetsDuplicated << std::endl;
-    std::cout << "PDR (%): " << pdr << std::endl;
-    std::cout << "PLR (%): " << plr << std::endl;
-    std::cout << "Retransmissão (%): " << retransmissionRate << std::endl;
-    std::cout << "Vazão (bps): " << throughput << std::endl;
-    std::cout << "Utilização do Canal (%): " << channelUtilization << std::endl;
-    std::cout << "Atraso Médio (s): " << avgDelay << std::endl;
-    std::cout << "Banda Utilizada (kHz): " << bandwidthUsed << std::endl;
-    std::cout << "Consumo Energia (J): " << totalEnergyConsumption << std::endl;
-
-    // Gerar arquivo CSV
-    std::ofstream csvFile("resultados_sigfox.csv");
-    csvFile << "Execução,Distância (m),Dispositivos,Pacotes Enviados,Pacotes Recebidos,Pacotes Duplicados,PDR (%),PLR (%),Retransmissão (%),Vazão (bps),Utilização do Canal (%),Atraso Médio (s),Banda Utilizada (kHz),Consumo Energia (J)\n";
-    csvFile << "1," << distance << "," << nDevices << "," << packetsSent << "," << packetsReceived << "," << packetsDuplicated << "," 
-            << pdr << "," << plr << "," << retransmissionRate << "," << throughput << "," << channelUtilization << "," 
-            << avgDelay << "," << bandwidthUsed << "," << totalEnergyConsumption << "\n";
-    csvFile.close();
 
+    lpwan::RunResult result;
+    result.run = RngSeedManager::GetRun();
+    result.devices = nDevices;
+    result.distance = distance;
+    result.packetsSent = totals.tx;
+    result.packetsReceived = totals.rx;
+    result.packetsDuplicated = totals.duplicates;
+    result.pdr = totals.tx > 0 ? ((double)totals.rx / totals.tx) * 100 : 0;
+    result.plr = totals.tx > 0 ? ((double)(totals.tx - totals.rx) / totals.tx) * 100 : 0;
+    result.retransmissionRate = 0.0; // Sigfox não tem retransmissão
+    result.throughput = totals.bytesReceived * 8.0 / 60.0; // bps
+    result.averageDelay = totals.rx > 0 ? totals.delaySum / totals.rx : 0;
+    lpwan::FillDelayPercentiles(result, metrics.GetLatency().all);
+    result.bandwidthUsed = bandwidthUsed;
+    result.channelUtilization = (totals.tx * 12 * 8) / (60.0 * bandwidthUsed * 1000) * 100;
+    result.energyConsumption = totals.energy;
+
+    profiler.Begin(lpwan::PHASE_TEARDOWN);
     Simulator::Destroy();
+    lpwan::RunProfile runProfile = profiler.Finish();
+
+    // Saída padronizada
+    lpwan::PrintRunResult(std::cout, "SIGFOX (SIMPLIFICADO)", result);
+    std::cout << "Pacotes Expirados: " << uidTracker.GetExpired() << std::endl;
+    lpwan::PrintRunProfile(std::cout, runProfile);
+
+    // Shard próprio (CSV + .lpwr) com semente, execução e hash da configuração
+    // Layout só entra no hash fora do padrão (shards antigos mantêm o hash)
+    lpwan::ConfigHash hash;
+    hash.Add("distance", distance).Add("nDevices", nDevices).Add("sensitivity", sensitivity);
+    if (!placement.IsDefault("line")) {
+        hash.Add("layout", placement.Describe());
+    }
+    uint64_t configHash = hash.Get();
+    lpwan::ResultSink sink("resultados_sigfox", lpwan::TECH_SIGFOX, "sigfox_simplificado", RngSeedManager::GetSeed(), configHash, 60.0);
+    if (profile) {
+        sink.SetExtraColumns(lpwan::ProfileCsvHeader());
+        sink.Add(result, lpwan::ProfileCsvRow(runProfile));
+    } else {
+        sink.Add(result);
+    }
+    sink.Flush();
     return 0;
 } 
\ No newline at end of file
@@ -10,32 +10,48 @@
 #include "ns3/mobility-module.h"
 #include "ns3/sigfox-module.h"
 #include "ns3/energy-module.h"
-#include <fstream>
+#include "../comum/lpwan-metrics.h"
+#include "../comum/lpwan-run-result.h"
+#include "../comum/lpwan-result-sink.h"
+#include "../comum/lpwan-placement.h"
+#include "../comum/lpwan-battery-recorder.h"
+#include "../comum/lpwan-outcome-store.h"
+#include "../comum/lpwan-profile.h"
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <vector>
-#include <algorithm>
 
 using namespace ns3;
 using namespace sigfox;
 
 // Variáveis globais
-int nDevices = 1;
-int nGateways = 1;
+uint32_t nDevices = 1;
+uint32_t nGateways = 1;
 double distance = 1000.0; // Distância em metros
 const int TotalTime = 62; // Tempo total da simulação em segundos
+const double appPeriod = 60.0; // Intervalo entre mensagens de cada dispositivo (s)
+lpwan::PlacementConfig placement; // Dispositivos a `distance` do gateway (anel)
+bool profile = false; // --profile: tempo por fase, eventos e memória
+lpwan::Profiler profiler;
 
 double battery = 100 * 60 * 60; // Energia total da bateria (360000 J)
 double EnergyConsumptionMeasurment = 0;
 double EnergyConsumptionNode = 0;
 double TotalRemainingEnergy = 0;
 
-// Métricas de rede
-uint32_t packetsSent = 0;
-uint32_t packetsReceived = 0;
-uint32_t packetsDuplicated = 0;
-double totalDelay = 0.0;
-double totalThroughput = 0.0;
-double channelUtilization = 0.0;
+// Série da bateria por dispositivo: amostras a cada batteryInterval segundos
+// num buffer em memória, gravado em blocos num arquivo por execução
+double batteryInterval = 60.0;
+EnergySourceContainer batterySources;
+lpwan::BatteryRecorder batteryRecorder;
+
+// Métricas de rede por dispositivo (índice = id do nó - id do primeiro dispositivo)
+lpwan::MetricsStore metrics;
+uint32_t firstDeviceId = 0;
+// Início da transmissão mais recente de cada dispositivo: cada repetição
+// termina de chegar ao gateway antes da próxima começar
+std::vector<double> lastSendTime;
 double bandwidthUsed = 100.0; // Sigfox usa 100 kHz
 
 // Funções de callback e rastreamento de energia
@@ -44,10 +60,11 @@ void Print () {
     TotalRemainingEnergy = battery - EnergyConsumptionNode - EnergyConsumptionMeasurment;
   if (TotalRemainingEnergy <= 0)
     TotalRemainingEnergy = 0;
-  std::ofstream out ("BatteryLevel.txt", std::ios::app);
-  out << Simulator::Now ().GetSeconds () << " , " << TotalRemainingEnergy << std::endl;
-  out.close ();
-  Simulator::Schedule (Seconds (60.0), &Print);
+  float *row = batteryRecorder.NextRow (Simulator::Now ().GetSeconds ());
+  for (uint32_t i = 0; i < batterySources.GetN (); ++i) {
+    row[i] = batterySources.Get (i)->GetRemainingEnergy ();
+  }
+  Simulator::Schedule (Seconds (batteryInterval), &Print);
 }
 
 void Measure () {
@@ -59,37 +76,28 @@ void TotalEnergy (double oldValue, double totalEnergy) {
   EnergyConsumptionNode = totalEnergy;
 }
 
-// Funções para análise de pacotes
-std::vector<std::vector<std::vector<bool>>> packetOutcomes;
+// Funções para análise de pacotes: um byte por (dispositivo, mensagem), um
+// bit por repetição. Só contam as mensagens observadas pela primeira vez
+// entre 10 s e TotalTime - 10 s
+lpwan::OutcomeStore packetOutcomes;
 void SetPacketOutcome (uint32_t senderId, uint8_t appPacket, uint8_t repetitionNumber, bool outcome) {
-  std::vector<std::vector<bool>> &senderOutcomes = packetOutcomes.at (senderId);
-  if (appPacket >= senderOutcomes.size ()) {
-    if (Simulator::Now () > Seconds (10) && Simulator::Now () < Seconds (TotalTime - 10)) {
-      senderOutcomes.push_back ({outcome});
-    }
-  } else {
-    senderOutcomes.at (appPacket).push_back (outcome);
-  }
+  double now = Simulator::Now ().GetSeconds ();
+  uint64_t packet = lpwan::UnwrapPacketNumber (appPacket, now / appPeriod);
+  bool counted = now > 10.0 && now < TotalTime - 10.0;
+  packetOutcomes.Set (senderId - firstDeviceId, packet, repetitionNumber, outcome, counted);
 }
 
-std::pair<int, int> CountSuccessesAndFailures () {
-  int failures = 0, successes = 0;
-  for (auto &senderOutcomes : packetOutcomes) {
-    for (auto &outcomes : senderOutcomes) {
-      if (std::none_of (outcomes.begin (), outcomes.end (), [] (bool v) {return v;})) failures++;
-      else successes++;
-    }
-  }
-  return {successes, failures};
+std::pair<uint64_t, uint64_t> CountSuccessesAndFailures () {
+  lpwan::OutcomeCount count = packetOutcomes.Count ();
+  return {count.successes, count.failures};
 }
 
 void ReceivedPacketAtGateway (Ptr<const Packet> packet, uint32_t id) {
   SigfoxTag tag;
   packet->PeekPacketTag (tag);
   SetPacketOutcome (tag.GetSenderId(), tag.GetPacketNumber(), tag.GetRepetitionNumber(), true);
-  packetsReceived++;
-  totalDelay += Simulator::Now().GetSeconds() - 10.0; // Tempo desde início
-  totalThroughput += packet->GetSize() * 8; // bits
+  uint32_t device = tag.GetSenderId () - firstDeviceId;
+  metrics.RecordRx (device, packet->GetSize (), Simulator::Now ().GetSeconds () - lastSendTime[device]);
 }
 
 void LostPacketAtGateway (Ptr<const Packet> packet, uint32_t id) {
@@ -98,15 +106,54 @@ void LostPacketAtGateway (Ptr<const Packet> packet, uint32_t id) {
   SetPacketOutcome (tag.GetSenderId(), tag.GetPacketNumber(), tag.GetRepetitionNumber(), false);
 }
 
-void PacketSentCallback (Ptr<const Packet> packet) {
-  packetsSent++;
+void PacketSentCallback (uint32_t device, Ptr<const Packet> packet) {
+  metrics.RecordTx (device);
+  lastSendTime[device] = Simulator::Now ().GetSeconds ();
+}
+
+// Liga os traces de todos os PHYs numa passada, na instalação: cada end
+// device leva o próprio índice no callback (sem caminhos Config:: nem
+// contexto por evento); os gateways alimentam o mesmo registro de repetições
+void ConnectSigfoxTraces (const NetDeviceContainer &endDeviceDevs, const NetDeviceContainer &gatewayDevs) {
+  for (uint32_t i = 0; i < endDeviceDevs.GetN (); ++i) {
+    Ptr<SigfoxPhy> phy = DynamicCast<SigfoxNetDevice> (endDeviceDevs.Get (i))->GetPhy ();
+    phy->TraceConnectWithoutContext ("SendPacket", MakeBoundCallback (&PacketSentCallback, i));
+  }
+  for (uint32_t g = 0; g < gatewayDevs.GetN (); ++g) {
+    Ptr<SigfoxPhy> phy = DynamicCast<SigfoxNetDevice> (gatewayDevs.Get (g))->GetPhy ();
+    phy->TraceConnectWithoutContext ("ReceivedPacket", MakeCallback (&ReceivedPacketAtGateway));
+    phy->TraceConnectWithoutContext ("LostPacketBecauseInterference", MakeCallback (&LostPacketAtGateway));
+  }
 }
 
 int main (int argc, char *argv[]) {
   CommandLine cmd;
   cmd.AddValue ("nDevices", "Número de dispositivos Sigfox", nDevices);
   cmd.AddValue ("distance", "Distância entre dispositivos e gateway (m)", distance);
+  cmd.AddValue ("layout", "Posição dos dispositivos: annulus, disc, grid, hex, line ou file", placement.layout);
+  cmd.AddValue ("layoutWidth", "Largura do anel no layout annulus (m)", placement.width);
+  cmd.AddValue ("layoutSpacing", "Espaçamento dos layouts grid, hex e line (m)", placement.spacing);
+  cmd.AddValue ("layoutFile", "Arquivo de posições do layout file (CSV/texto ou .bin)", placement.file);
+  cmd.AddValue ("batteryInterval", "Intervalo entre amostras da bateria (s)", batteryInterval);
+  cmd.AddValue ("profile", "Tempo por fase, eventos/s, pico de memória e alocações por evento", profile);
   cmd.Parse (argc, argv);
+  // Intervalo <= 0 reagendaria Print() no mesmo instante para sempre
+  if (!(batteryInterval > 0.0))
+    {
+      std::cerr << "--batteryInterval deve ser positivo: " << batteryInterval << std::endl;
+      return 1;
+    }
+  profiler.Enable (profile);
+  profiler.Begin (lpwan::PHASE_BUILD);
+
+  // Layout só entra no hash fora do padrão (shards antigos mantêm o hash)
+  lpwan::ConfigHash hash;
+  hash.Add ("nDevices", nDevices).Add ("distance", distance);
+  if (!placement.IsDefault ("annulus"))
+    {
+      hash.Add ("layout", placement.Describe ());
+    }
+  uint64_t configHash = hash.Get ();
 
   // Canal
   Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel> ();
@@ -115,21 +162,21 @@ int main (int argc, char *argv[]) {
   Ptr<PropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
   Ptr<SigfoxChannel> channel = CreateObject<SigfoxChannel> (loss, delay);
 
-  // Mobilidade
-  MobilityHelper mobility;
-  Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator> ();
-  allocator->Add (Vector (0, 0, 0)); // Gateway
-  allocator->Add (Vector (distance, 0, 0)); // Dispositivo
-  mobility.SetPositionAllocator (allocator);
-  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-
   // Instalação dos dispositivos e gateways
   NodeContainer endDevices, gateways;
   endDevices.Create (nDevices);
   gateways.Create (nGateways);
-  mobility.Install (endDevices);
-  mobility.Install (gateways);
 
+  // Mobilidade: gateways na origem, dispositivos pelo layout escolhido
+  placement.count = nDevices;
+  placement.radius = distance;
+  placement.seed = lpwan::PlacementSeed (RngSeedManager::GetSeed (), RngSeedManager::GetRun ());
+  lpwan::InstallPlacement (endDevices, lpwan::GeneratePlacement (placement));
+  for (uint32_t g = 0; g < gateways.GetN (); ++g) {
+    lpwan::InstallPosition (gateways.Get (g), 0.0, 0.0, 0.0);
+  }
+
+  profiler.Begin (lpwan::PHASE_INSTALL);
   SigfoxHelper helper;
   SigfoxPhyHelper phyHelper;
   SigfoxMacHelper macHelper;
@@ -137,16 +184,17 @@ int main (int argc, char *argv[]) {
   phyHelper.SetDeviceType (SigfoxPhyHelper::EP);
   macHelper.SetDeviceType (SigfoxMacHelper::EP);
   NetDeviceContainer endDevicesNetDevices = helper.Install (phyHelper, macHelper, endDevices);
-  packetOutcomes.resize(nDevices);
+  packetOutcomes.Reset (nDevices, static_cast<uint32_t> (TotalTime / appPeriod) + 2);
+  metrics.Reset (nDevices);
+  lastSendTime.assign (nDevices, 0.0);
+  firstDeviceId = endDevices.Get (0)->GetId ();
 
   phyHelper.SetDeviceType (SigfoxPhyHelper::GW);
   macHelper.SetDeviceType (SigfoxMacHelper::GW);
-  helper.Install (phyHelper, macHelper, gateways);
+  NetDeviceContainer gatewayNetDevices = helper.Install (phyHelper, macHelper, gateways);
 
   // Conectar callbacks
-  gateways.Get (0)->GetDevice (0)->GetObject<SigfoxNetDevice> ()->GetPhy ()->TraceConnectWithoutContext("ReceivedPacket", MakeCallback(&ReceivedPacketAtGateway));
-  gateways.Get (0)->GetDevice (0)->GetObject<SigfoxNetDevice> ()->GetPhy ()->TraceConnectWithoutContext("LostPacketBecauseInterference", MakeCallback(&LostPacketAtGateway));
-  endDevices.Get (0)->GetDevice (0)->GetObject<SigfoxNetDevice> ()->GetPhy ()->TraceConnectWithoutContext("SendPacket", MakeCallback(&PacketSentCallback));
+  ConnectSigfoxTraces (endDevicesNetDevices, gatewayNetDevices);
 
   // Energia
   SdcEnergySourceHelper energyHelper;
@@ -154,62 +202,75 @@ int main (int argc, char *argv[]) {
   energyHelper.Set ("SdcEnergySourceInitialEnergyJ", DoubleValue (3600));
   EnergySourceContainer sources = energyHelper.Install (endDevices);
   DeviceEnergyModelContainer devices = radioHelper.Install (endDevicesNetDevices, sources);
+  batterySources = sources;
+
+  std::ostringstream batteryName;
+  batteryName << "bateria_sigfox_" << std::hex << std::setw (16) << std::setfill ('0') << configHash << std::dec
+              << "_s" << RngSeedManager::GetSeed () << "_r" << RngSeedManager::GetRun () << ".lpwb";
+  batteryRecorder.Open (batteryName.str (), sources.GetN (), batteryInterval);
 
   Ptr<SdcEnergySource> energy = DynamicCast<SdcEnergySource> (sources.Get (0));
   energy->TraceConnectWithoutContext ("RemainingEnergy", MakeCallback (&TotalEnergy));
 
   // Aplicação
   PeriodicSenderHelper appHelper;
-  appHelper.SetPeriod (Seconds (60));
+  appHelper.SetPeriod (Seconds (appPeriod));
   appHelper.SetPacketSize (12);
   ApplicationContainer apps = appHelper.Install (endDevices);
   apps.Start (Seconds (0));
   apps.Stop (Seconds (TotalTime));
 
   // Simulação
-  Simulator::Schedule (Seconds (60.0), &Print);
+  Simulator::Schedule (Seconds (batteryInterval), &Print);
   Simulator::Schedule (Seconds (60.0), &Measure);
   Simulator::Stop (Seconds (TotalTime));
+  profiler.Begin (lpwan::PHASE_RUN);
   Simulator::Run ();
+  profiler.End ();
+  batteryRecorder.Close ();
+  profiler.Begin (lpwan::PHASE_TEARDOWN);
   Simulator::Destroy ();
+  lpwan::RunProfile runProfile = profiler.Finish ();
 
   // Cálculo das métricas finais
   auto [successes, failures] = CountSuccessesAndFailures();
   
-  double pdr = packetsSent > 0 ? ((double)packetsReceived / packetsSent) * 100 : 0;
-  double plr = packetsSent > 0 ? ((double)(packetsSent - packetsReceived) / packetsSent) * 100 : 0;
-  double retransmissionRate = 0.0; // Sigfox não tem retransmissão explícita
-  double throughput = totalThroughput / TotalTime; // bps
-  double avgDelay = packetsReceived > 0 ? totalDelay / packetsReceived : 0;
-  double energyConsumption = battery - TotalRemainingEnergy;
-  
+  lpwan::MetricsTotals totals = metrics.Aggregate ();
+
+  lpwan::RunResult result;
+  result.run = RngSeedManager::GetRun ();
+  result.devices = nDevices;
+  result.distance = distance;
+  result.packetsSent = totals.tx;
+  result.packetsReceived = totals.rx;
+  result.packetsDuplicated = totals.duplicates;
+  result.pdr = totals.tx > 0 ? ((double)totals.rx / totals.tx) * 100 : 0;
+  result.plr = totals.tx > 0 ? ((double)(totals.tx - totals.rx) / totals.tx) * 100 : 0;
+  result.retransmissionRate = 0.0; // Sigfox não tem retransmissão explícita
+  result.throughput = totals.bytesReceived * 8.0 / TotalTime; // bps
+  result.averageDelay = totals.rx > 0 ? totals.delaySum / totals.rx : 0;
+  lpwan::FillDelayPercentiles (result, metrics.GetLatency ().all);
+  result.bandwidthUsed = bandwidthUsed;
+  result.energyConsumption = battery - TotalRemainingEnergy;
+
   // Calcular utilização do canal (simplificado)
-  channelUtilization = (packetsSent * 12 * 8) / (TotalTime * bandwidthUsed * 1000) * 100; // %
+  result.channelUtilization = (totals.tx * 12 * 8) / (TotalTime * bandwidthUsed * 1000) * 100; // %
 
   // Saída padronizada
-  std::cout << "=== RESULTADOS SIGFOX ===" << std::endl;
-  std::cout << "Execução: 1" << std::endl;
-  std::cout << "Distância (m): " << distance << std::endl;
-  std::cout << "Dispositivos: " << nDevices << std::endl;
-  std::cout << "Pacotes Enviados: " << packetsSent << std::endl;
-  std::cout << "Pacotes Recebidos: " << packetsReceived << std::endl;
-  std::cout << "Pacotes Duplicados: " << packetsDuplicated << std::endl;
-  std::cout << "PDR (%): " << pdr << std::endl;
-  std::cout << "PLR (%): " << plr << std::endl;
-  std::cout << "Retransmissão (%): " << retransmissionRate << std::endl;
-  std::cout << "Vazão (bps): " << throughput << std::endl;
-  std::cout << "Utilização do Canal (%): " << channelUtilization << std::endl;
-  std::cout << "Atraso Médio (s): " << avgDelay << std::endl;
-  std::cout << "Banda Utilizada (kHz): " << bandwidthUsed << std::endl;
-  std::cout << "Consumo Energia (J): " << energyConsumption << std::endl;
-
-  // Gerar arquivo CSV
-  std::ofstream csvFile("resultados_sigfox.csv");
-  csvFile << "Execução,Distância (m),Dispositivos,Pacotes Enviados,Pacotes Recebidos,Pacotes Duplicados,PDR (%),PLR (%),Retransmissão (%),Vazão (bps),Utilização do Canal (%),Atraso Médio (s),Banda Utilizada (kHz),Consumo Energia (J)\n";
-  csvFile << "1," << distance << "," << nDevices << "," << packetsSent << "," << packetsReceived << "," << packetsDuplicated << "," 
-          << pdr << "," << plr << "," << retransmissionRate << "," << throughput << "," << channelUtilization << "," 
-          << avgDelay << "," << bandwidthUsed << "," << energyConsumption << "\n";
-  csvFile.close();
+  lpwan::PrintRunResult (std::cout, "SIGFOX", result);
+  lpwan::PrintRunProfile (std::cout, runProfile);
+  std::cout << "Mensagens Entregues (alguma repetição): " << successes << std::endl;
+  std::cout << "Mensagens Perdidas (todas as repetições): " << failures << std::endl;
+
+  // Shard próprio (CSV + .lpwr) com semente, execução e hash da configuração
+  lpwan::ResultSink sink ("resultados_sigfox", lpwan::TECH_SIGFOX, "sigfox_simulacao_explicada", RngSeedManager::GetSeed (), configHash, TotalTime);
+  if (profile) {
+    sink.SetExtraColumns (lpwan::ProfileCsvHeader ());
+    sink.Add (result, lpwan::ProfileCsvRow (runProfile));
+  } else {
+    sink.Add (result);
+  }
+  sink.Flush ();
 
   return 0;
 }
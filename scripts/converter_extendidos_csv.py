@@ -2,10 +2,15 @@
 """
 Conversor de Resultados Extendidos para CSV
 Converte todos os arquivos .txt em resultados_extendidos/ para CSV
+
+Se houver arquivos binários .lpwr (gravados pelos simuladores), a conversão é
+delegada ao build/lpwan-export, que lê as colunas direto via mmap.
 """
 
 import os
 import re
+import shutil
+import subprocess
 import pandas as pd
 import glob
 
@@ -18,19 +23,19 @@ def parse_resultado_extendido(file_path):
     patterns = {
         'tecnologia': r'=== RESULTADOS (\w+) ===',
         'execucao': r'Execução: (\d+)',
-        'distancia': r'Distância \(m\): (\d+)',
+        'distancia': r'Distância \(m\): ([\d.eE+-]+)',
         'dispositivos': r'Dispositivos: (\d+)',
         'pacotes_enviados': r'Pacotes Enviados: (\d+)',
         'pacotes_recebidos': r'Pacotes Recebidos: (\d+)',
         'pacotes_duplicados': r'Pacotes Duplicados: (\d+)',
-        'pdr': r'PDR \(%\): (\d+)',
-        'plr': r'PLR \(%\): (\d+)',
-        'retransmissao': r'Retransmissão \(%\): (\d+)',
-        'vazao': r'Vazão \(bps\): (\d+)',
-        'utilizacao': r'Utilização do Canal \(%\): (\d+)',
-        'atraso': r'Atraso Médio \(s\): (\d+)',
-        'banda': r'Banda Utilizada \(kHz\): (\d+)',
-        'energia': r'Consumo Energia \(J\): (\d+)'
+        'pdr': r'PDR \(%\): ([\d.eE+-]+)',
+        'plr': r'PLR \(%\): ([\d.eE+-]+)',
+        'retransmissao': r'Retransmissão \(%\): ([\d.eE+-]+)',
+        'vazao': r'Vazão \(bps\): ([\d.eE+-]+)',
+        'utilizacao': r'Utilização do Canal \(%\): ([\d.eE+-]+)',
+        'atraso': r'Atraso Médio \(s\): ([\d.eE+-]+)',
+        'banda': r'Banda Utilizada \(kHz\): ([\d.eE+-]+)',
+        'energia': r'Consumo Energia \(J\): ([\d.eE+-]+)'
     }
     
     resultado = {}
@@ -40,6 +45,19 @@ def parse_resultado_extendido(file_path):
             resultado[key] = match.group(1)
         else:
             resultado[key] = '0'
+
+    # Percentis do atraso: só os simuladores NS-3 imprimem (sem eles a
+    # coluna fica vazia, não zero)
+    percentis = {
+        'atraso_p50': r'Atraso p50 \(s\): ([\d.eE+-]+)',
+        'atraso_p90': r'Atraso p90 \(s\): ([\d.eE+-]+)',
+        'atraso_p99': r'Atraso p99 \(s\): ([\d.eE+-]+)',
+        'atraso_max': r'Atraso Máximo \(s\): ([\d.eE+-]+)'
+    }
+    for key, pattern in percentis.items():
+        match = re.search(pattern, content)
+        if match:
+            resultado[key] = match.group(1)
     
     return resultado
 
@@ -48,6 +66,16 @@ def converter_extendidos_csv():
     print("=== CONVERSOR DE RESULTADOS EXTENDIDOS PARA CSV ===")
     print("")
     
+    # Caminho rápido: resultados binários
+    # (mesma regra do lpwan-export: .lpwr do diretório ou, sem nenhum, de shards/)
+    if glob.glob('resultados_extendidos/*.lpwr') or glob.glob('resultados_extendidos/shards/*.lpwr'):
+        exportador = shutil.which('lpwan-export') or os.path.join(
+            os.path.dirname(os.path.abspath(__file__)), '..', 'build', 'lpwan-export')
+        if os.path.exists(exportador):
+            print("⚡ Arquivos .lpwr encontrados, usando lpwan-export")
+            subprocess.run([exportador, '--por-tecnologia', 'resultados_extendidos'], check=True)
+            return
+
     # Verificar se o diretório existe
     if not os.path.exists('resultados_extendidos'):
         print("❌ Diretório 'resultados_extendidos' não encontrado!")
@@ -86,7 +114,8 @@ def converter_extendidos_csv():
     # Converter colunas numéricas
     colunas_numericas = ['execucao', 'distancia', 'dispositivos', 'pacotes_enviados', 
                         'pacotes_recebidos', 'pacotes_duplicados', 'pdr', 'plr', 
-                        'retransmissao', 'vazao', 'utilizacao', 'atraso', 'banda', 'energia']
+                        'retransmissao', 'vazao', 'utilizacao', 'atraso', 'atraso_p50', 'atraso_p90',
+                        'atraso_p99', 'atraso_max', 'banda', 'energia']
     
     for col in colunas_numericas:
         if col in df.columns:
@@ -107,6 +136,10 @@ def converter_extendidos_csv():
         'vazao': 'Vazão (bps)',
         'utilizacao': 'Utilização do Canal (%)',
         'atraso': 'Atraso Médio (s)',
+        'atraso_p50': 'Atraso p50 (s)',
+        'atraso_p90': 'Atraso p90 (s)',
+        'atraso_p99': 'Atraso p99 (s)',
+        'atraso_max': 'Atraso Máximo (s)',
         'banda': 'Banda Utilizada (kHz)',
         'energia': 'Consumo Energia (J)'
     })
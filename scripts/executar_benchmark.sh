@@ -0,0 +1,58 @@
+#!/bin/bash
+
+echo "=== BENCHMARK DE ESCALA DOS SIMULADORES LPWAN ==="
+echo ""
+
+# Diretórios
+PROJETO_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+NS3_DIR="${NS3_DIR:-$HOME/ns3_test/ns-3-dev}"
+BIN_DIR="$PROJETO_DIR/build"
+BENCH_BIN="$BIN_DIR/lpwan-bench"
+
+# Compilar o benchmark (não depende do NS-3)
+mkdir -p "$BIN_DIR"
+FONTE="$PROJETO_DIR/codigos/ferramentas/lpwan-bench.cc"
+if [ ! -x "$BENCH_BIN" ] || [ "$FONTE" -nt "$BENCH_BIN" ]; then
+    echo "🔧 Compilando lpwan-bench..."
+    if ! g++ -O2 -std=c++17 "$FONTE" -o "$BENCH_BIN"; then
+        echo "❌ Falha na compilação do lpwan-bench"
+        exit 1
+    fi
+fi
+
+if [ ! -f "$NS3_DIR/ns3" ]; then
+    echo "❌ NS-3 não encontrado em $NS3_DIR"
+    echo "   Defina NS3_DIR ou execute scripts/instalar_ns3.sh"
+    exit 1
+fi
+
+# Os seis simuladores, inclusive as versões simplificadas
+echo "📡 Copiando simuladores para $NS3_DIR/scratch..."
+cp "$PROJETO_DIR/codigos/lorawan/lorawan-test.cc" "$NS3_DIR/scratch/"
+cp "$PROJETO_DIR/codigos/lorawan/lorawan_simplificado.cc" "$NS3_DIR/scratch/"
+cp "$PROJETO_DIR/codigos/nbiot/nb-iot-sim.cc" "$NS3_DIR/scratch/"
+cp "$PROJETO_DIR/codigos/nbiot/nbiot_simplificado.cc" "$NS3_DIR/scratch/"
+cp "$PROJETO_DIR/codigos/sigfox/sigfox_simulacao_explicada.cc" "$NS3_DIR/scratch/"
+cp "$PROJETO_DIR/codigos/sigfox/sigfox_simplificado.cc" "$NS3_DIR/scratch/"
+mkdir -p "$NS3_DIR/comum"
+cp "$PROJETO_DIR"/codigos/comum/*.h "$NS3_DIR/comum/"
+
+echo "🔧 Compilando simuladores..."
+if ! (cd "$NS3_DIR" && ./ns3 build); then
+    echo "❌ Falha na compilação do NS-3"
+    exit 1
+fi
+
+echo ""
+echo "⏱️  Medindo (um ponto por vez; a máquina deve estar ociosa)..."
+echo ""
+"$BENCH_BIN" --ns3="$NS3_DIR" "$@"
+STATUS=$?
+
+echo ""
+case $STATUS in
+    0) echo "✅ BENCHMARK CONCLUÍDO!" ;;
+    3) echo "❌ Regressão de desempenho contra a linha de base" ;;
+    *) echo "⚠️  Benchmark terminou com falhas (veja os logs em <out>/logs/)" ;;
+esac
+exit $STATUS
@@ -0,0 +1,60 @@
+#!/bin/bash
+
+echo "=== VARREDURA LPWAN COM SIMULADORES NS-3 REAIS ==="
+echo ""
+
+# Diretórios
+PROJETO_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+NS3_DIR="${NS3_DIR:-$HOME/ns3_test/ns-3-dev}"
+BIN_DIR="$PROJETO_DIR/build"
+SWEEP_BIN="$BIN_DIR/lpwan-sweep"
+
+# Compilar o executor e o exportador (não dependem do NS-3)
+mkdir -p "$BIN_DIR"
+for FERRAMENTA in lpwan-sweep lpwan-export; do
+    FONTE="$PROJETO_DIR/codigos/ferramentas/$FERRAMENTA.cc"
+    if [ ! -x "$BIN_DIR/$FERRAMENTA" ] || [ "$FONTE" -nt "$BIN_DIR/$FERRAMENTA" ] || \
+       [ "$PROJETO_DIR/codigos/comum/lpwan-results-bin.h" -nt "$BIN_DIR/$FERRAMENTA" ]; then
+        echo "🔧 Compilando $FERRAMENTA..."
+        if ! g++ -O2 -std=c++17 -pthread "$FONTE" -o "$BIN_DIR/$FERRAMENTA"; then
+            echo "❌ Falha na compilação do $FERRAMENTA"
+            exit 1
+        fi
+    fi
+done
+
+# Os simuladores precisam estar em scratch/ e compilados antes da varredura
+if [ ! -f "$NS3_DIR/ns3" ]; then
+    echo "❌ NS-3 não encontrado em $NS3_DIR"
+    echo "   Defina NS3_DIR ou execute scripts/instalar_ns3.sh"
+    exit 1
+fi
+
+echo "📡 Copiando simuladores para $NS3_DIR/scratch..."
+cp "$PROJETO_DIR/codigos/lorawan/lorawan-test.cc" "$NS3_DIR/scratch/"
+cp "$PROJETO_DIR/codigos/nbiot/nb-iot-sim.cc" "$NS3_DIR/scratch/"
+cp "$PROJETO_DIR/codigos/sigfox/sigfox_simulacao_explicada.cc" "$NS3_DIR/scratch/"
+# Headers compartilhados: os simuladores incluem "../comum/*.h"
+mkdir -p "$NS3_DIR/comum"
+cp "$PROJETO_DIR"/codigos/comum/*.h "$NS3_DIR/comum/"
+
+echo "🔧 Compilando simuladores..."
+if ! (cd "$NS3_DIR" && ./ns3 build); then
+    echo "❌ Falha na compilação do NS-3"
+    exit 1
+fi
+
+echo ""
+echo "🚀 Iniciando varredura (retoma automaticamente pontos já concluídos)..."
+echo ""
+"$SWEEP_BIN" --ns3="$NS3_DIR" "$@"
+STATUS=$?
+
+echo ""
+if [ $STATUS -eq 0 ]; then
+    echo "✅ VARREDURA CONCLUÍDA!"
+else
+    echo "⚠️  Varredura terminou com falhas (veja os logs em <out>/logs/)"
+    echo "   Execute novamente para repetir apenas os pontos pendentes."
+fi
+exit $STATUS